@@ -0,0 +1,57 @@
+/** 	
+	@name Arena.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Monotonic arena.
+ */
+
+#include "Arena.h"
+#include <stdlib.h>
+
+MonotonicArena::MonotonicArena(size_t slabSize)
+ : cursor(NULL), limit(NULL), slabSize(slabSize), reserved(0), used(0) { }
+
+MonotonicArena::~MonotonicArena() {
+   for (size_t i = 0; i < slabs.size(); i++) { free(slabs[i]); }
+}
+
+/**
+	Start a new slab big enough for bytes and allocate from it. A request
+	larger than a quarter slab gets a block of its own, so the current
+	slab keeps its free space.
+ */
+void* MonotonicArena::allocateSlow(size_t bytes) {
+   if (4 * bytes > slabSize && cursor != NULL) {
+      char* own = (char*)malloc(bytes);
+      slabs.push_back(own);
+      reserved += bytes;
+      used += bytes;
+      return own;
+   }
+   size_t size = (bytes > slabSize) ? bytes : slabSize;
+   char* slab = (char*)malloc(size);
+   slabs.push_back(slab);
+   reserved += size;
+   cursor = slab + bytes;
+   limit = slab + size;
+   used += bytes;
+   return slab;
+}
+
+/**
+	Take over every slab of other, which is left empty. Memory already
+	handed out by other stays valid for the life of this arena.
+ */
+void MonotonicArena::adopt(MonotonicArena& other) {
+   slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+   reserved += other.reserved;
+   used += other.used;
+   if (cursor == NULL) {
+      cursor = other.cursor;
+      limit = other.limit;
+   }
+   other.slabs.clear();
+   other.cursor = other.limit = NULL;
+   other.reserved = other.used = 0;
+}
@@ -0,0 +1,54 @@
+/** 	
+	@name Arena.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Monotonic arena. Memory is handed out by bumping a pointer through
+	large slabs and is never freed piece by piece; every slab is released
+	together when the arena is destroyed.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <vector>
+#include <stddef.h>
+
+using namespace std;
+
+class MonotonicArena {
+   vector<char*> slabs;
+   char* cursor;         // next free byte of the newest slab
+   char* limit;          // end of the newest slab
+   size_t slabSize;
+   size_t reserved;      // bytes in all slabs
+   size_t used;          // bytes handed out
+
+   MonotonicArena(const MonotonicArena&);
+   MonotonicArena& operator=(const MonotonicArena&);
+
+ public:
+   explicit MonotonicArena(size_t slabSize = 1 << 20);
+   ~MonotonicArena();
+
+	/**
+		Return bytes of memory aligned to align, which must be a power of
+		two no larger than alignof(max_align_t).
+	*/
+   void* allocate(size_t bytes, size_t align) {
+      char* p = (char*)(((size_t)cursor + align - 1) & ~(align - 1));
+      if (cursor == NULL || p + bytes > limit) { return allocateSlow(bytes); }
+      cursor = p + bytes;
+      used += bytes;
+      return p;
+   }
+
+   void* allocateSlow(size_t bytes);
+   void adopt(MonotonicArena& other);
+
+   size_t bytes() const { return reserved; }
+   size_t bytesUsed() const { return used; }
+   size_t slabCount() const { return slabs.size(); }
+};
+
+#endif
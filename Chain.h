@@ -0,0 +1,87 @@
+/** 	
+	@name Chain.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	A word chain: a PeekDeque of interned word ids that also keeps a set
+	of the ids it holds, so duplicate checks do not have to walk it.
+ */
+
+#ifndef CHAIN_H_
+#define CHAIN_H_
+
+#include "PeekDeque.h"
+#include "WordPool.h"
+#include "WordSet.h"
+
+class Chain : public PeekDeque<uint32_t> {
+
+   const WordPool* pool;
+   bool trackMembers;
+   WordSet members;
+
+ public:
+
+   Chain(const WordPool* pool, bool trackMembers, MonotonicArena* arena = NULL)
+    : pool(pool), trackMembers(trackMembers) { if (arena) { useArena(arena); } }
+
+	/**
+		Add a word to the front of the chain and record it as a member.
+	*/
+   void pushFront(uint32_t newItem) {
+      PeekDeque<uint32_t>::pushFront(newItem);
+      if (trackMembers) { members.insert(newItem); }
+   }
+
+	/**
+		Add a word to the rear of the chain and record it as a member.
+	*/
+   void pushRear(uint32_t newItem) {
+      PeekDeque<uint32_t>::pushRear(newItem);
+      if (trackMembers) { members.insert(newItem); }
+   }
+
+	/**
+		Determines whether word is already in the chain. Only valid when
+		the chain tracks its members.
+	*/
+   bool contains(uint32_t word) const { return members.contains(word); }
+
+	/**
+		Returns each word in the chain, separated by a space.
+	*/
+   string toString() const {
+      ostringstream OUT;
+      for (int i = 0; i < this->count; i++) {
+         OUT << pool->str(this->item(i)) << " ";
+      }
+      return OUT.str();
+   }
+
+};
+
+/**
+	Owns chains made from two monotonic arenas: one holding the Chain
+	objects back to back in creation order, one holding the word storage
+	they grow into. Nothing is freed until the ChainArena goes away.
+*/
+class ChainArena {
+   MonotonicArena objects;
+   MonotonicArena storage;
+   vector<Chain*> created;
+
+   ChainArena(const ChainArena&);
+   ChainArena& operator=(const ChainArena&);
+
+ public:
+   ChainArena() : objects(4096 * sizeof(Chain)), storage(1 << 20) { }
+   ~ChainArena();
+
+   Chain* create(const WordPool* pool, bool trackMembers);
+   void adopt(ChainArena& other);
+
+   size_t bytes() const { return objects.bytes() + storage.bytes() + created.capacity() * sizeof(Chain*); }
+   size_t size() const { return created.size(); }
+};
+
+#endif
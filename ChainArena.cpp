@@ -0,0 +1,40 @@
+/** 	
+	@name ChainArena.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Arena ownership of chains.
+ */
+
+#include "Chain.h"
+
+/**
+	Run each chain's destructor (only member sets hold heap memory),
+	then let both arenas release their slabs.
+ */
+ChainArena::~ChainArena() {
+   for (size_t i = 0; i < created.size(); i++) { created[i]->~Chain(); }
+}
+
+/**
+	Make an empty chain in the arena.
+ */
+Chain* ChainArena::create(const WordPool* pool, bool trackMembers) {
+   void* at = objects.allocate(sizeof(Chain), alignof(Chain));
+   Chain* chain = new (at) Chain(pool, trackMembers, &storage);
+   created.push_back(chain);
+   return chain;
+}
+
+/**
+	Take ownership of every chain made in other, which is left empty.
+	The adopted chains grow from this arena's storage from now on, since
+	other may be destroyed.
+ */
+void ChainArena::adopt(ChainArena& other) {
+   objects.adopt(other.objects);
+   storage.adopt(other.storage);
+   for (size_t i = 0; i < other.created.size(); i++) { other.created[i]->arenaAdopted(&storage); }
+   created.insert(created.end(), other.created.begin(), other.created.end());
+   other.created.clear();
+}
@@ -0,0 +1,573 @@
+/** 	
+	@name ChainBuilder.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Builds word chains from a sequence of interned words.
+ */
+
+#include "ChainBuilder.h"
+#include "EditDistance.h"
+#include "Profile.h"
+#include "Snapshot.h"
+#include <thread>
+#include <algorithm>
+
+/**
+	Check for re-occurrence of a specific word in a chain
+ */
+bool checkDuplicate(uint32_t word, int i, vector<Chain* >& chains) {
+	profileCount(DUPLICATE_CHECKS);
+	return chains.at(i)->contains(word);
+}
+
+/** 
+	Add word to a new or existing chain.
+	The word joins the first chain (lowest index) with an end at
+	distance one under Distance, trying that chain's front before its
+	rear. The first chain with a matching end is found through index
+	rather than by scanning every chain; under step growth the index
+	also applies the length rule, so no distance test is run here. The
+	duplicate and step growth rules are template arguments, so each
+	combination compiles to its own loop with the unused checks removed.
+	Returns the index of the chain that received the word. When stats is
+	given it is updated with the word and the chain that took it; when
+	arena is given new chains are made in it rather than on the heap.
+ */
+template <typename Distance, bool AllowDuplicate, bool StepGrowth>
+static int placeWord(uint32_t word, vector<Chain* >& chains, EndpointIndex& index, const WordPool& pool, ChainStats* stats, ChainArena* arena) {
+	string_view text = pool.str(word);
+	Endpoint match = index.first(text, Distance::METRIC, StepGrowth); // already checked against the step growth rule
+	
+	if(match.chain != -1) { // add word into EXISTING chain
+		int i = match.chain;
+		if(AllowDuplicate || !checkDuplicate(word, i, chains)) {
+			if(match.end == FRONT) {
+				index.erase(pool.str(chains.at(i)->returnFront()), i, FRONT);
+				chains.at(i)->pushFront(word);
+				index.insert(text, word, i, FRONT);
+			} else {
+				index.erase(pool.str(chains.at(i)->returnRear()), i, REAR);
+				chains.at(i)->pushRear(word);
+				index.insert(text, word, i, REAR);
+			}
+			if(stats) { stats->grewChain(i, chains.at(i)->size(), word, text.length()); }
+			return i;
+		}
+	}
+	
+	// otherwise create a NEW chain
+	Chain* newpd = arena ? arena->create(&pool, !AllowDuplicate) : new Chain(&pool, !AllowDuplicate);
+	
+	newpd->pushFront(word);
+	profileCount(CHAINS_CREATED);
+	
+	chains.push_back(newpd);
+	index.insert(text, word, chains.size() - 1, FRONT);
+	index.insert(text, word, chains.size() - 1, REAR);
+	if(stats) { stats->newChain(chains.size() - 1, word, text.length()); }
+	return chains.size() - 1;
+}
+
+template <typename Distance>
+static WordPlacer selectRules(bool allowDuplicate, bool stepGrowth) {
+	if(allowDuplicate) {
+		return stepGrowth ? placeWord<Distance, true, true> : placeWord<Distance, true, false>;
+	}
+	return stepGrowth ? placeWord<Distance, false, true> : placeWord<Distance, false, false>;
+}
+
+/** 
+	Pick the placeWord instantiation for a metric and set of rules. Call
+	once, then place every word through the returned function.
+ */
+WordPlacer selectPlacer(Metric metric, bool allowDuplicate, bool stepGrowth) {
+	switch(metric) {
+		case HAMMING: return selectRules<HammingDistance>(allowDuplicate, stepGrowth);
+		case EXTENSION: return selectRules<ExtensionDistance>(allowDuplicate, stepGrowth);
+		default: return selectRules<LevenshteinDistance>(allowDuplicate, stepGrowth);
+	}
+}
+
+/** 
+	Add word to a new or existing chain by edit distance, choosing the
+	rules at run time. Prefer selectPlacer() when placing many words.
+ */
+int testNewWord(uint32_t word, vector<Chain* >& chains, EndpointIndex& index, const WordPool& pool, const bool& allowDuplicate, const bool& stepGrowth, ChainStats* stats, ChainArena* arena) {
+	return selectPlacer(EDIT, allowDuplicate, stepGrowth)(word, chains, index, pool, stats, arena);
+}
+
+/** 
+	Tokenize the input on several threads, then intern the words in file
+	order so every word gets the same id a serial read would give it.
+ */
+void readWordsParallel(const char* data, size_t size, int filterLength, int threads, WordPool& pool, vector<uint32_t>& words) {
+	vector<size_t> cuts = splitAtWhitespace(data, size, threads);
+	vector<WordPool> pools(threads);
+	vector<vector<uint32_t> > ids(threads);
+	vector<thread> workers;
+	
+	for(int s = 0; s < threads; s++) { // each thread reads its own slice into its own pool
+		workers.push_back(thread([&, s]() {
+			Tokenizer tokens(data + cuts[s], cuts[s + 1] - cuts[s], filterLength);
+			string_view word;
+			while(tokens.next(word)) {
+				ids[s].push_back(pools[s].intern(word));
+			}
+		}));
+	}
+	for(int s = 0; s < threads; s++) { workers[s].join(); }
+	
+	for(int s = 0; s < threads; s++) { // translate slice ids to shared ids, slice by slice
+		vector<uint32_t> shared(pools[s].size(), WordPool::NOT_FOUND);
+		for(std::vector<uint32_t>::size_type k = 0; k != ids[s].size(); k++) {
+			uint32_t id = ids[s][k];
+			if(shared[id] == WordPool::NOT_FOUND) {
+				shared[id] = pool.intern(pools[s].str(id));
+			}
+			words.push_back(shared[id]);
+		}
+	}
+}
+
+/** 
+	Count how often each word occurs, on several threads. Each thread
+	counts its slice in its own pool; the pools are then merged slice by
+	slice, so words are interned in order of first occurrence, as a
+	serial read would, and counts[id] is the total for word id. Only the
+	distinct words of each slice are kept, never the token stream.
+	Returns the number of words read.
+ */
+size_t countWordsParallel(const char* data, size_t size, int filterLength, int threads, WordPool& pool, vector<uint32_t>& counts) {
+	vector<size_t> cuts = splitAtWhitespace(data, size, threads);
+	vector<WordPool> pools(threads);
+	vector<vector<uint32_t> > sliceCounts(threads);
+	vector<thread> workers;
+	
+	for(int s = 0; s < threads; s++) {
+		workers.push_back(thread([&, s]() {
+			Tokenizer tokens(data + cuts[s], cuts[s + 1] - cuts[s], filterLength);
+			string_view word;
+			while(tokens.next(word)) {
+				uint32_t id = pools[s].intern(word);
+				if(id == sliceCounts[s].size()) { sliceCounts[s].push_back(0); }
+				sliceCounts[s][id]++;
+			}
+		}));
+	}
+	for(int s = 0; s < threads; s++) { workers[s].join(); }
+	
+	size_t total = 0;
+	for(int s = 0; s < threads; s++) {
+		for(uint32_t id = 0; id < pools[s].size(); id++) {
+			uint32_t shared = pool.intern(pools[s].str(id));
+			if(shared >= counts.size()) { counts.resize(shared + 1, 0); }
+			counts[shared] += sliceCounts[s][id];
+			total += sliceCounts[s][id];
+		}
+	}
+	return total;
+}
+
+/** 
+	Build chains on several threads at once. Each shard owns one band of
+	word lengths (bands hold roughly equal numbers of words) and has its
+	own chains and endpoint index, so shards never share state. Chains do
+	not cross band boundaries. The shards are appended in band order, so
+	the same thread count always produces the same chains. Each shard
+	keeps its own statistics and arena, merged into stats and arena with
+	the chains.
+ */
+void buildSharded(const vector<uint32_t>& words, const WordPool& pool, int threads, const bool& allowDuplicate, const bool& stepGrowth, vector<Chain* >& chains, ChainStats* stats, ChainArena* arena, Metric metric) {
+	WordPlacer place = selectPlacer(metric, allowDuplicate, stepGrowth);
+
+	vector<size_t> histogram;
+	for(std::vector<uint32_t>::size_type k = 0; k != words.size(); k++) {
+		size_t length = pool.length(words[k]);
+		if(length >= histogram.size()) { histogram.resize(length + 1, 0); }
+		histogram[length]++;
+	}
+	
+	vector<int> bandOf(histogram.size());
+	size_t filled = 0;
+	int band = 0;
+	for(std::vector<size_t>::size_type length = 0; length != histogram.size(); length++) {
+		bandOf[length] = band;
+		filled += histogram[length];
+		if(band < threads - 1 && filled * threads >= (band + 1) * words.size()) { band++; }
+	}
+	
+	vector<vector<Chain* > > shards(threads);
+	vector<ChainStats> shardStats(threads);
+	vector<ChainArena> shardArenas(threads);
+	vector<thread> workers;
+	for(int s = 0; s < threads; s++) {
+		workers.push_back(thread([&, s]() {
+			EndpointIndex index;
+			for(std::vector<uint32_t>::size_type k = 0; k != words.size(); k++) {
+				if(bandOf[pool.length(words[k])] == s) {
+					place(words[k], shards[s], index, pool, &shardStats[s], arena ? &shardArenas[s] : NULL);
+				}
+			}
+		}));
+	}
+	for(int s = 0; s < threads; s++) { workers[s].join(); }
+	
+	for(int s = 0; s < threads; s++) { // deterministic merge
+		if(stats) { stats->merge(shardStats[s], chains.size()); }
+		if(arena) { arena->adopt(shardArenas[s]); }
+		chains.insert(chains.end(), shards[s].begin(), shards[s].end());
+	}
+}
+
+/** 
+	Move every word of other onto the keeper end of keeper, starting with
+	the word at other's joining end, so the joined chain reads straight
+	across the join.
+ */
+static void absorb(Chain* keeper, ChainEnd keeperEnd, const Chain* other, ChainEnd otherEnd) {
+	int n = other->size();
+	for(int k = 0; k < n; k++) {
+		uint32_t word = other->item(otherEnd == FRONT ? k : n - 1 - k);
+		if(keeperEnd == FRONT) {
+			keeper->pushFront(word);
+		} else {
+			keeper->pushRear(word);
+		}
+	}
+}
+
+/** 
+	Try to join chain i end to end with another chain. Both ends of i are
+	looked up in index, rear first; the lowest numbered chain with an end
+	at distance one that satisfies the rules is joined, reversing it if
+	the two ends face the same way. With step growth only front-to-rear
+	joins keep the lengths decreasing, so chains are never reversed. The
+	smaller chain is moved into the larger one, added to gone and its
+	slot set to NULL.
+	Returns the index of the joined chain, or -1 when i has no partner.
+ */
+template <typename Distance, bool AllowDuplicate, bool StepGrowth>
+static int joinChain(int i, vector<Chain* >& chains, EndpointIndex& index, const WordPool& pool, vector<Chain* >& gone) {
+	for(int e = REAR; e >= FRONT; e--) {
+		ChainEnd end = ChainEnd(e);
+		uint32_t word = (end == FRONT) ? chains[i]->returnFront() : chains[i]->returnRear();
+		
+		Endpoint partner;
+		bool found = index.firstAccepted(pool.str(word), Distance::METRIC, [&](const Endpoint& p) {
+			if(p.chain == i) { return false; }
+			uint32_t otherWord = (p.end == FRONT) ? chains[p.chain]->returnFront() : chains[p.chain]->returnRear();
+			
+			if(StepGrowth) { // only front-to-rear joins, with lengths decreasing across the join
+				if(p.end == end) { return false; }
+				size_t before = pool.length(end == REAR ? word : otherWord);
+				size_t after = pool.length(end == REAR ? otherWord : word);
+				if(before <= after) { return false; }
+			}
+			
+			if(!AllowDuplicate) { // check the smaller chain's words against the larger chain's members
+				const Chain* larger = (chains[i]->size() >= chains[p.chain]->size()) ? chains[i] : chains[p.chain];
+				const Chain* smaller = (larger == chains[i]) ? chains[p.chain] : chains[i];
+				for(size_t w = 0; w < smaller->size(); w++) {
+					profileCount(DUPLICATE_CHECKS);
+					if(larger->contains(smaller->item(w))) { return false; }
+				}
+			}
+			return true;
+		}, partner);
+		
+		if(found) {
+			int j = partner.chain;
+			ChainEnd other = partner.end;
+			bool keepI = chains[i]->size() >= chains[j]->size();
+			int keeper = keepI ? i : j;
+			int moved = keepI ? j : i;
+			ChainEnd keeperEnd = keepI ? end : other;
+			ChainEnd movedEnd = keepI ? other : end;
+			
+			uint32_t keeperWord = (keeperEnd == FRONT) ? chains[keeper]->returnFront() : chains[keeper]->returnRear();
+			index.erase(pool.str(keeperWord), keeper, keeperEnd);
+			index.erase(pool.str(chains[moved]->returnFront()), moved, FRONT);
+			index.erase(pool.str(chains[moved]->returnRear()), moved, REAR);
+			absorb(chains[keeper], keeperEnd, chains[moved], movedEnd);
+			keeperWord = (keeperEnd == FRONT) ? chains[keeper]->returnFront() : chains[keeper]->returnRear();
+			index.insert(pool.str(keeperWord), keeperWord, keeper, keeperEnd);
+			gone.push_back(chains[moved]);
+			chains[moved] = NULL;
+			profileCount(CHAINS_MERGED);
+			return keeper;
+		}
+	}
+	return -1;
+}
+
+template <typename Distance, bool AllowDuplicate, bool StepGrowth>
+static size_t joinAll(vector<Chain* >& chains, const WordPool& pool, vector<Chain* >& gone) {
+	EndpointIndex index;
+	for(std::vector<Chain*>::size_type i = 0; i != chains.size(); i++) {
+		index.insert(pool.str(chains[i]->returnFront()), chains[i]->returnFront(), i, FRONT);
+		index.insert(pool.str(chains[i]->returnRear()), chains[i]->returnRear(), i, REAR);
+	}
+	
+	size_t joins = 0;
+	for(std::vector<Chain*>::size_type i = 0; i != chains.size(); i++) {
+		int current = chains[i] ? i : -1; // a chain already moved into another one is skipped
+		while(current != -1) {
+			current = joinChain<Distance, AllowDuplicate, StepGrowth>(current, chains, index, pool, gone);
+			if(current != -1) { joins++; }
+		}
+	}
+	return joins;
+}
+
+template <typename Distance>
+static size_t joinRules(vector<Chain* >& chains, const WordPool& pool, bool allowDuplicate, bool stepGrowth, vector<Chain* >& gone) {
+	if(allowDuplicate) {
+		return stepGrowth ? joinAll<Distance, true, true>(chains, pool, gone) : joinAll<Distance, true, false>(chains, pool, gone);
+	}
+	return stepGrowth ? joinAll<Distance, false, true>(chains, pool, gone) : joinAll<Distance, false, false>(chains, pool, gone);
+}
+
+/** 
+	Join chains whose ends are within distance one of each other, under
+	the same duplicate and step growth rules the chains were built with.
+	Every chain is visited once in order and joined with partners found
+	through an endpoint index until it has none left; the smaller chain
+	of each pair is always moved into the larger, so no word is copied
+	more than log(chains) times. Emptied chains are removed, keeping the
+	others in order, and deleted unless they came from arena. When stats
+	is given it is rebuilt for the joined chains. Returns the number of
+	joins.
+ */
+size_t mergeChains(vector<Chain* >& chains, const WordPool& pool, Metric metric, bool allowDuplicate, bool stepGrowth, ChainStats* stats, ChainArena* arena) {
+	vector<Chain* > gone;
+	size_t joins;
+	switch(metric) {
+		case HAMMING: joins = joinRules<HammingDistance>(chains, pool, allowDuplicate, stepGrowth, gone); break;
+		case EXTENSION: joins = joinRules<ExtensionDistance>(chains, pool, allowDuplicate, stepGrowth, gone); break;
+		default: joins = joinRules<LevenshteinDistance>(chains, pool, allowDuplicate, stepGrowth, gone); break;
+	}
+	
+	chains.erase(remove(chains.begin(), chains.end(), (Chain*)NULL), chains.end());
+	if(!arena) {
+		for(std::vector<Chain*>::size_type k = 0; k != gone.size(); k++) { delete gone[k]; }
+	}
+	
+	if(stats) {
+		*stats = ChainStats();
+		for(std::vector<Chain*>::size_type i = 0; i != chains.size(); i++) {
+			for(size_t k = 0; k < chains[i]->size(); k++) {
+				uint32_t word = chains[i]->item(k);
+				if(k == 0) {
+					stats->newChain(i, word, pool.length(word));
+				} else {
+					stats->grewChain(i, k + 1, word, pool.length(word));
+				}
+			}
+		}
+	}
+	return joins;
+}
+
+ChainSet::ChainSet(bool allowDuplicate, bool stepGrowth, Metric metric)
+ : wordPool(new WordPool()), chainArena(new ChainArena()), words(0), duplicates(allowDuplicate), growth(stepGrowth), distance(metric) { }
+
+/** 
+	Find the words within distance one of word under the set's metric,
+	appending their ids to found in id order, and the chains with an end
+	at one of them to ends, in chain order: the chains word could join.
+	word need not have been added. The pool is screened in one pass with
+	an EditPattern, so this suits one-off queries that do not justify
+	building a trie. Returns the number of words found.
+ */
+size_t ChainSet::neighbors(string_view word, vector<uint32_t>& found, vector<int>& ends) const {
+	WordPoolArrays packed = wordPool->arrays();
+	EditPattern pattern(word);
+	size_t first = found.size();
+	pattern.screen(packed.chars, packed.offsets, packed.words, found);
+	if(distance != EDIT) { // Hamming and extension neighbors are a subset of the edit neighbors
+		profileCount(DISTANCE_TESTS, found.size() - first);
+		size_t kept = first;
+		for(size_t k = first; k < found.size(); k++) {
+			string_view text = wordPool->str(found[k]);
+			if(distance == HAMMING ? hd1(word, text) : xd1(word, text)) { found[kept++] = found[k]; }
+		}
+		found.resize(kept);
+	}
+	
+	vector<bool> near(wordPool->size(), false);
+	for(size_t k = first; k < found.size(); k++) { near[found[k]] = true; }
+	for(size_t i = 0; i < chainList.size(); i++) {
+		if(near[chainList[i]->returnFront()] || near[chainList[i]->returnRear()]) { ends.push_back(i); }
+	}
+	return found.size() - first;
+}
+
+ChainBuilder::ChainBuilder(bool allowDuplicate, bool stepGrowth, Metric metric)
+ : building(allowDuplicate, stepGrowth, metric), indexed(true), place(selectPlacer(metric, allowDuplicate, stepGrowth)) { }
+
+/** 
+	Enter both ends of every chain into a fresh index, after the chains
+	were made without it.
+ */
+void ChainBuilder::reindex() {
+	index = EndpointIndex();
+	indexChains(building.chainList, *building.wordPool, index);
+	indexed = true;
+}
+
+/** 
+	Add one word to the chains. Returns the index of the chain that took
+	it, or -1 if the word is empty or not made of the letters a-z.
+ */
+int ChainBuilder::add(string_view word) {
+	if(!WordTrie::isWord(word)) { return -1; }
+	if(!indexed) { reindex(); }
+	building.words++;
+	return place(building.wordPool->intern(word), building.chainList, index, *building.wordPool, &building.chainStats, building.chainArena.get());
+}
+
+/** 
+	Add count words in order, as add() would.
+ */
+void ChainBuilder::addBatch(const string_view* words, size_t count) {
+	PhaseTimer timer(PHASE_BUILD);
+	for(size_t k = 0; k < count; k++) { add(words[k]); }
+}
+
+/** 
+	Tokenize a buffer and add every word that passes the filter, reading
+	straight from data. Returns the number of words added.
+ */
+size_t ChainBuilder::addText(const char* data, size_t size, int filterLength) {
+	PhaseTimer timer(PHASE_BUILD);
+	Tokenizer tokens(data, size, filterLength);
+	string_view word;
+	size_t added = 0;
+	while(tokens.next(word)) {
+		add(word);
+		added++;
+	}
+	return added;
+}
+
+/** 
+	Tokenize a buffer on several threads, then build chains from it. The
+	chains are built in shards by word length, unless deterministic is
+	set or chains already exist, in which case the words are placed one
+	at a time exactly as addText() would. Returns the number of words
+	added.
+ */
+size_t ChainBuilder::addParallel(const char* data, size_t size, int filterLength, int threads, bool deterministic) {
+	vector<uint32_t> words;
+	{
+		PhaseTimer timer(PHASE_READ);
+		readWordsParallel(data, size, filterLength, threads, *building.wordPool, words);
+	}
+	
+	PhaseTimer timer(PHASE_BUILD);
+	building.words += words.size();
+	if(deterministic || !building.chainList.empty()) { // same attach order as a serial run
+		if(!indexed) { reindex(); }
+		for(std::vector<uint32_t>::size_type k = 0; k != words.size(); k++) {
+			place(words[k], building.chainList, index, *building.wordPool, &building.chainStats, building.chainArena.get());
+		}
+	} else {
+		buildSharded(words, *building.wordPool, threads, building.duplicates, building.growth, building.chainList, &building.chainStats, building.chainArena.get(), building.distance);
+		indexed = false;
+	}
+	return words.size();
+}
+
+/** 
+	Count one occurrence of word for addCounted() instead of adding it.
+ */
+void ChainBuilder::count(string_view word) {
+	if(!WordTrie::isWord(word)) { return; }
+	uint32_t id = building.wordPool->intern(word);
+	if(id >= building.counts.size()) { building.counts.resize(id + 1, 0); }
+	building.counts[id]++;
+	building.words++;
+}
+
+/** 
+	Count every word of a buffer on several threads for addCounted().
+	Returns the number of words read.
+ */
+size_t ChainBuilder::countParallel(const char* data, size_t size, int filterLength, int threads) {
+	PhaseTimer timer(PHASE_READ);
+	size_t read = countWordsParallel(data, size, filterLength, threads, *building.wordPool, building.counts);
+	building.words += read;
+	return read;
+}
+
+/** 
+	Add each counted word once, in order of first occurrence, if it was
+	counted at least minFrequency times. Returns the number of words
+	added.
+ */
+size_t ChainBuilder::addCounted(uint32_t minFrequency) {
+	PhaseTimer timer(PHASE_BUILD);
+	if(!indexed) { reindex(); }
+	size_t added = 0;
+	for(std::vector<uint32_t>::size_type id = 0; id != building.counts.size(); id++) {
+		if(building.counts[id] == 0 || building.counts[id] < minFrequency) { continue; }
+		place(id, building.chainList, index, *building.wordPool, &building.chainStats, building.chainArena.get());
+		added++;
+	}
+	return added;
+}
+
+/** 
+	Join chains end to end, see mergeChains(). Returns the number of
+	joins.
+ */
+size_t ChainBuilder::merge() {
+	PhaseTimer timer(PHASE_MERGE);
+	size_t joins = mergeChains(building.chainList, *building.wordPool, building.distance, building.duplicates, building.growth, &building.chainStats, building.chainArena.get());
+	indexed = false;
+	return joins;
+}
+
+/** 
+	Replace everything built so far with the chains in a snapshot. Words
+	added afterwards follow the rules stored in the snapshot.
+ */
+bool ChainBuilder::load(const string& path, string& error) {
+	PhaseTimer timer(PHASE_LOAD);
+	ChainSet loaded;
+	SnapshotInfo info;
+	if(!loadSnapshot(path, *loaded.wordPool, loaded.chainList, loaded.chainStats, info, error, loaded.chainArena.get())) {
+		return false;
+	}
+	loaded.words = info.wordCount;
+	loaded.duplicates = info.allowDuplicate;
+	loaded.growth = info.stepGrowth;
+	loaded.distance = info.metric;
+	
+	building = move(loaded);
+	place = selectPlacer(building.distance, building.duplicates, building.growth);
+	indexed = false; // indexed when the first word is added
+	return true;
+}
+
+/** 
+	Write the chains built so far to a snapshot that load() can restore.
+ */
+bool ChainBuilder::save(const string& path, string& error) const {
+	PhaseTimer timer(PHASE_SAVE);
+	SnapshotInfo info = { building.words, building.duplicates, building.growth, building.distance };
+	return saveSnapshot(path, *building.wordPool, building.chainList, info, error);
+}
+
+/** 
+	Hand over the chains built so far. The builder starts again empty,
+	under the same rules.
+ */
+ChainSet ChainBuilder::finish() {
+	ChainSet done(move(building));
+	building = ChainSet(done.duplicates, done.growth, done.distance);
+	index = EndpointIndex();
+	indexed = true;
+	return done;
+}
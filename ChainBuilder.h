@@ -0,0 +1,153 @@
+/** 	
+	@name ChainBuilder.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Builds word chains from a sequence of interned words.
+	
+	Programs embedding the generator use the ChainBuilder class: feed it
+	words, whole in-memory buffers or snapshots, then take the finished
+	ChainSet. The free functions below are the pieces it is made from.
+ */
+
+#ifndef CHAINBUILDER_H_
+#define CHAINBUILDER_H_
+
+#include "Chain.h"
+#include "ChainStats.h"
+#include "EndpointIndex.h"
+#include "Tokenizer.h"
+#include "EditDistance.h"
+#include <iterator>
+#include <memory>
+
+typedef int (*WordPlacer)(uint32_t word, vector<Chain* >& chains, EndpointIndex& index, const WordPool& pool, ChainStats* stats, ChainArena* arena);
+
+bool checkDuplicate(uint32_t word, int i, vector<Chain* >& chains);
+WordPlacer selectPlacer(Metric metric, bool allowDuplicate, bool stepGrowth);
+int testNewWord(uint32_t word, vector<Chain* >& chains, EndpointIndex& index, const WordPool& pool, const bool& allowDuplicate, const bool& stepGrowth, ChainStats* stats = NULL, ChainArena* arena = NULL);
+void readWordsParallel(const char* data, size_t size, int filterLength, int threads, WordPool& pool, vector<uint32_t>& words);
+size_t mergeChains(vector<Chain* >& chains, const WordPool& pool, Metric metric, bool allowDuplicate, bool stepGrowth, ChainStats* stats = NULL, ChainArena* arena = NULL);
+size_t countWordsParallel(const char* data, size_t size, int filterLength, int threads, WordPool& pool, vector<uint32_t>& counts);
+void buildSharded(const vector<uint32_t>& words, const WordPool& pool, int threads, const bool& allowDuplicate, const bool& stepGrowth, vector<Chain* >& chains, ChainStats* stats = NULL, ChainArena* arena = NULL, Metric metric = EDIT);
+
+/**
+	Chains together with the word pool their ids refer to, the arena they
+	live in and their statistics. Move-only, since the chains point at the
+	pool and arena owned here.
+*/
+class ChainSet {
+   unique_ptr<WordPool> wordPool;
+   unique_ptr<ChainArena> chainArena;
+   vector<Chain* > chainList;
+   ChainStats chainStats;
+   vector<uint32_t> counts;   // by word id: occurrences counted, if the input was counted first
+   size_t words;              // words added or counted, counting repeats
+   bool duplicates;
+   bool growth;
+   Metric distance;
+
+   ChainSet(const ChainSet&);
+   ChainSet& operator=(const ChainSet&);
+
+   friend class ChainBuilder;
+
+ public:
+
+	/**
+		Walks the chains in order.
+	*/
+   class const_iterator {
+      vector<Chain* >::const_iterator at;
+
+    public:
+      typedef forward_iterator_tag iterator_category;
+      typedef Chain value_type;
+      typedef ptrdiff_t difference_type;
+      typedef const Chain* pointer;
+      typedef const Chain& reference;
+
+      explicit const_iterator(vector<Chain* >::const_iterator at) : at(at) { }
+
+      const Chain& operator*() const { return **at; }
+      const Chain* operator->() const { return *at; }
+      const_iterator& operator++() { ++at; return *this; }
+      const_iterator operator++(int) { const_iterator was = *this; ++at; return was; }
+      bool operator==(const const_iterator& other) const { return at == other.at; }
+      bool operator!=(const const_iterator& other) const { return at != other.at; }
+   };
+
+   ChainSet(bool allowDuplicate = true, bool stepGrowth = false, Metric metric = EDIT);
+   ChainSet(ChainSet&& other) = default;
+   ChainSet& operator=(ChainSet&& other) = default;
+
+   const_iterator begin() const { return const_iterator(chainList.begin()); }
+   const_iterator end() const { return const_iterator(chainList.end()); }
+   size_t size() const { return chainList.size(); }
+   const Chain& operator[](size_t i) const { return *chainList[i]; }
+
+	/**
+		Returns the text of a word id held in a chain.
+	*/
+   string_view word(uint32_t id) const { return wordPool->str(id); }
+
+   const vector<Chain* >& chains() const { return chainList; }
+   const WordPool& pool() const { return *wordPool; }
+   const ChainArena& arena() const { return *chainArena; }
+   const ChainStats& stats() const { return chainStats; }
+   const vector<uint32_t>& frequencies() const { return counts; }
+   size_t wordCount() const { return words; }
+   bool allowDuplicate() const { return duplicates; }
+   bool stepGrowth() const { return growth; }
+   Metric metric() const { return distance; }
+
+   size_t neighbors(string_view word, vector<uint32_t>& found, vector<int>& ends) const;
+};
+
+/**
+	Builds a ChainSet a word, a batch or a buffer at a time, under rules
+	fixed when it is made (or taken from a loaded snapshot). Words passed
+	to add() and addBatch() must already be lowercase letters; addText() and
+	addParallel() tokenize a buffer in place, trimming, lowercasing and
+	filtering it as the command line does, without copying it first.
+	
+	Alternatively count() and countParallel() only tally the words, and
+	addCounted() then adds each distinct word once, skipping those seen
+	fewer than a given number of times; the counts stay available as
+	the result's frequencies().
+*/
+class ChainBuilder {
+   ChainSet building;
+   EndpointIndex index;
+   bool indexed;              // index covers every chain in building
+   WordPlacer place;
+
+   ChainBuilder(const ChainBuilder&);
+   ChainBuilder& operator=(const ChainBuilder&);
+
+   void reindex();
+
+ public:
+   ChainBuilder(bool allowDuplicate = true, bool stepGrowth = false, Metric metric = EDIT);
+
+   int add(string_view word);
+   void addBatch(const string_view* words, size_t count);
+   void addBatch(const vector<string_view>& words) { addBatch(words.data(), words.size()); }
+   size_t addText(const char* data, size_t size, int filterLength = 0);
+   size_t addParallel(const char* data, size_t size, int filterLength, int threads, bool deterministic = false);
+   void count(string_view word);
+   size_t countParallel(const char* data, size_t size, int filterLength, int threads);
+   size_t addCounted(uint32_t minFrequency = 1);
+   size_t merge();
+
+   bool load(const string& path, string& error);
+   bool save(const string& path, string& error) const;
+
+	/**
+		The chains built so far; valid until the next change.
+	*/
+   const ChainSet& result() const { return building; }
+   ChainSet finish();
+};
+
+#endif
@@ -0,0 +1,399 @@
+/**
+	@name ChainServer.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+
+	Answers queries about a finished ChainSet, for --serve.
+ */
+
+#include "ChainServer.h"
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+static const size_t MAX_LINE = 4096; // longer lines are answered with an error and skipped
+
+static const char* commandName[SERVE_COMMANDS] = { "chains", "longest", "neighbors", "chain", "stats" };
+
+/**
+	Build the reverse indexes and the trie. Each chain is listed once
+	per word however often it holds the word, and the lists are in chain
+	order because the chains are walked in order, so the longest chain
+	through a word is the first of the longest in its list.
+ */
+ChainServer::ChainServer(const ChainSet& chains)
+ : set(chains), started(chrono::steady_clock::now()), stopping(false), listener(-1)
+{
+   for (int c = 0; c < SERVE_COMMANDS; c++) {
+      for (int b = 0; b < LATENCY_BUCKETS; b++) { latency[c][b] = 0; }
+      latencyTotal[c] = 0;
+   }
+
+   const WordPool& pool = set.pool();
+   size_t words = pool.size();
+   for (uint32_t id = 0; id < words; id++) { trie.insert(pool.str(id), id); }
+
+   const vector<Chain* >& list = set.chains();
+   vector<int> seen(words, -1);
+   longest.assign(words, -1);
+   memberStart.assign(words + 1, 0);
+   endStart.assign(words + 1, 0);
+   for (size_t i = 0; i < list.size(); i++) { // count, then place, each list
+      for (size_t k = 0; k < list[i]->size(); k++) {
+         uint32_t word = list[i]->item(k);
+         if (seen[word] != (int)i) { seen[word] = i; memberStart[word + 1]++; }
+      }
+      endStart[list[i]->returnFront() + 1]++;
+      if (list[i]->returnRear() != list[i]->returnFront()) { endStart[list[i]->returnRear() + 1]++; }
+   }
+   for (size_t w = 0; w < words; w++) {
+      memberStart[w + 1] += memberStart[w];
+      endStart[w + 1] += endStart[w];
+   }
+
+   members.resize(memberStart[words]);
+   ends.resize(endStart[words]);
+   vector<uint32_t> memberAt(memberStart.begin(), memberStart.end() - 1);
+   vector<uint32_t> endAt(endStart.begin(), endStart.end() - 1);
+   fill(seen.begin(), seen.end(), -1);
+   for (size_t i = 0; i < list.size(); i++) {
+      for (size_t k = 0; k < list[i]->size(); k++) {
+         uint32_t word = list[i]->item(k);
+         if (seen[word] != (int)i) {
+            seen[word] = i;
+            members[memberAt[word]++] = i;
+            if (longest[word] < 0 || list[i]->size() > list[longest[word]]->size()) { longest[word] = i; }
+         }
+      }
+      ends[endAt[list[i]->returnFront()]++] = i;
+      if (list[i]->returnRear() != list[i]->returnFront()) { ends[endAt[list[i]->returnRear()]++] = i; }
+   }
+}
+
+/**
+	Memory held by the indexes and the trie.
+ */
+size_t ChainServer::bytes() const {
+   return trie.bytes() + (memberStart.capacity() + endStart.capacity()) * sizeof(uint32_t)
+        + (members.capacity() + ends.capacity() + longest.capacity()) * sizeof(int);
+}
+
+/**
+	Add the time since start to a command's histogram.
+ */
+void ChainServer::record(ServerCommand command, chrono::steady_clock::time_point start) {
+   uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+   int bucket = (ns == 0) ? 0 : 64 - __builtin_clzll(ns);
+   if (bucket >= LATENCY_BUCKETS) { bucket = LATENCY_BUCKETS - 1; }
+   latency[command][bucket].fetch_add(1, memory_order_relaxed);
+   latencyTotal[command].fetch_add(ns, memory_order_relaxed);
+}
+
+/**
+	Write "chain", "length" and "words" fields for one chain.
+ */
+void ChainServer::writeChain(int chain, ReportWriter& out) const {
+   const Chain& c = set[chain];
+   out << "\"chain\":" << chain << ",\"length\":" << c.size() << ",\"words\":[";
+   for (size_t k = 0; k < c.size(); k++) {
+      out << (k ? ",\"" : "\"") << set.word(c.item(k)) << '"';
+   }
+   out << ']';
+}
+
+/**
+	Write the stats reply: the size of the set and the indexes, and for
+	each command its count, mean and the upper bounds of the buckets
+	holding its median, 99th percentile and slowest answer, followed by
+	its non-empty buckets as [upper bound, count] pairs. Times are in
+	microseconds and measure the work of answering, not the socket.
+ */
+void ChainServer::writeStats(ReportWriter& out) const {
+   double uptime = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+   out << "{\"command\":\"stats\",\"chains\":" << set.size() << ",\"words\":" << set.pool().size()
+       << ",\"index_bytes\":" << bytes() << ",\"uptime_seconds\":" << uptime << ",\"latency\":{";
+   for (int c = 0; c < SERVE_COMMANDS; c++) {
+      uint64_t counts[LATENCY_BUCKETS];
+      uint64_t total = 0;
+      for (int b = 0; b < LATENCY_BUCKETS; b++) {
+         counts[b] = latency[c][b].load(memory_order_relaxed);
+         total += counts[b];
+      }
+      double mean = total ? latencyTotal[c].load(memory_order_relaxed) / 1000.0 / total : 0;
+      double p50 = 0, p99 = 0, slowest = 0;
+      uint64_t below = 0;
+      for (int b = 0; b < LATENCY_BUCKETS; b++) {
+         if (counts[b] == 0) { continue; }
+         double upper = (double)((uint64_t)1 << b) / 1000;
+         if (p50 == 0 && 2 * (below + counts[b]) >= total) { p50 = upper; }
+         if (p99 == 0 && 100 * (below + counts[b]) >= 99 * total) { p99 = upper; }
+         slowest = upper;
+         below += counts[b];
+      }
+
+      out << (c ? ",\"" : "\"") << commandName[c] << "\":{\"count\":" << total << ",\"mean_us\":" << mean
+          << ",\"p50_us\":" << p50 << ",\"p99_us\":" << p99 << ",\"max_us\":" << slowest << ",\"buckets\":[";
+      bool first = true;
+      for (int b = 0; b < LATENCY_BUCKETS; b++) {
+         if (counts[b] == 0) { continue; }
+         out << (first ? "[" : ",[") << (double)((uint64_t)1 << b) / 1000 << ',' << counts[b] << ']';
+         first = false;
+      }
+      out << "]}";
+   }
+   out << "}}\n";
+}
+
+/**
+	Answer one command line. Returns false when the client is done:
+	after quit, or after shutdown, which also sets shutdown.
+ */
+bool ChainServer::answer(string_view line, ReportWriter& out, bool& shutdown) {
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) { line.remove_suffix(1); }
+   while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) { line.remove_prefix(1); }
+   if (line.empty()) { return true; }
+
+   size_t space = line.find_first_of(" \t");
+   string_view command = line.substr(0, space);
+   string_view argument = (space == string_view::npos) ? string_view() : line.substr(space + 1);
+   while (!argument.empty() && (argument.front() == ' ' || argument.front() == '\t')) { argument.remove_prefix(1); }
+
+   if (command == "quit") { return false; }
+   if (command == "shutdown") {
+      out << "{\"command\":\"shutdown\"}\n";
+      shutdown = true;
+      return false;
+   }
+   if (command == "stats") {
+      writeStats(out);
+      record(SERVE_STATS, start);
+      return true;
+   }
+   if (command == "chain") {
+      string number(argument);
+      char* end = NULL;
+      unsigned long chain = strtoul(number.c_str(), &end, 10);
+      if (number.empty() || *end != '\0' || number[0] == '-' || chain >= set.size()) {
+         out << "{\"error\":\"no such chain\"}\n";
+      } else {
+         out << "{\"command\":\"chain\",";
+         writeChain(chain, out);
+         out << "}\n";
+      }
+      record(SERVE_CHAIN, start);
+      return true;
+   }
+
+   ServerCommand which;
+   if (command == "chains") {
+      which = SERVE_CHAINS;
+   } else if (command == "longest") {
+      which = SERVE_LONGEST;
+   } else if (command == "neighbors") {
+      which = SERVE_NEIGHBORS;
+   } else {
+      out << "{\"error\":\"unknown command\"}\n";
+      return true;
+   }
+
+   string word(argument);
+   for (size_t k = 0; k < word.size(); k++) { word[k] = tolower((unsigned char)word[k]); }
+   if (!WordTrie::isWord(word)) {
+      out << "{\"error\":\"not a word\"}\n";
+      record(which, start);
+      return true;
+   }
+
+   uint32_t id = set.pool().find(word);
+   out << "{\"command\":\"" << commandName[which] << "\",\"word\":\"" << word << "\",";
+   if (which == SERVE_CHAINS) {
+      out << "\"chains\":[";
+      if (id != WordPool::NOT_FOUND) {
+         for (uint32_t k = memberStart[id]; k < memberStart[id + 1]; k++) {
+            out << (k != memberStart[id] ? "," : "") << members[k];
+         }
+      }
+      out << "]}\n";
+   } else if (which == SERVE_LONGEST) {
+      int best = (id == WordPool::NOT_FOUND) ? -1 : longest[id];
+      if (best < 0) {
+         out << "\"chain\":-1,\"length\":0,\"words\":[]}\n";
+      } else {
+         writeChain(best, out);
+         out << "}\n";
+      }
+   } else {
+      vector<uint32_t> found;
+      vector<int> joinable;
+      trie.neighbors(word, set.metric(), found);
+      for (size_t n = 0; n < found.size(); n++) {
+         joinable.insert(joinable.end(), ends.begin() + endStart[found[n]], ends.begin() + endStart[found[n] + 1]);
+      }
+      sort(joinable.begin(), joinable.end());
+      joinable.erase(unique(joinable.begin(), joinable.end()), joinable.end());
+
+      out << "\"words\":[";
+      for (size_t n = 0; n < found.size(); n++) {
+         out << (n ? ",\"" : "\"") << set.word(found[n]) << '"';
+      }
+      out << "],\"chains\":[";
+      for (size_t n = 0; n < joinable.size(); n++) {
+         out << (n ? "," : "") << joinable[n];
+      }
+      out << "]}\n";
+   }
+   record(which, start);
+   return true;
+}
+
+/**
+	Serve one client: read command lines from in and write replies to
+	out until the client quits, its input ends or the server stops.
+	Replies to every complete line in one read go out in one write, so
+	pipelined commands cost one system call per batch.
+ */
+void ChainServer::serve(int in, int out) {
+   ReportWriter reply(out, 1 << 16);
+   string pending; // a line split across reads
+   char buffer[1 << 12];
+   bool open = true;
+   bool overlong = false;
+   bool shutdown = false;
+
+   while (open && !stopping.load()) {
+      ssize_t n = read(in, buffer, sizeof(buffer));
+      if (n < 0 && errno == EINTR) { continue; }
+      if (n <= 0) { break; }
+
+      const char* p = buffer;
+      const char* end = buffer + n;
+      while (open && p < end) {
+         const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+         if (newline == NULL) {
+            if (!overlong) { pending.append(p, end - p); }
+            if (pending.size() > MAX_LINE) {
+               pending.clear();
+               overlong = true;
+            }
+            break;
+         }
+         if (overlong || pending.size() + (newline - p) > MAX_LINE) {
+            reply << "{\"error\":\"line too long\"}\n";
+            overlong = false;
+         } else if (pending.empty()) {
+            open = answer(string_view(p, newline - p), reply, shutdown);
+         } else {
+            pending.append(p, newline - p);
+            open = answer(pending, reply, shutdown);
+         }
+         pending.clear();
+         p = newline + 1;
+      }
+      reply.flush();
+   }
+   if (open && !overlong && !pending.empty() && !stopping.load()) { // last line had no newline
+      answer(pending, reply, shutdown);
+   }
+   reply.flush();
+
+   if (shutdown) { stop(); }
+}
+
+/**
+	Stop serving: wake the threads waiting for connections and end every
+	connection still open.
+ */
+void ChainServer::stop() {
+   stopping = true;
+   lock_guard<mutex> lock(clientsLock);
+   if (listener >= 0) { ::shutdown(listener, SHUT_RDWR); }
+   for (size_t k = 0; k < clients.size(); k++) { ::shutdown(clients[k], SHUT_RDWR); }
+}
+
+/**
+	Worker thread: take connections one at a time until the server stops.
+ */
+void ChainServer::acceptClients() {
+   while (!stopping.load()) {
+      int fd = accept(listener, NULL, NULL);
+      if (fd < 0) {
+         if (stopping.load()) { break; }
+         if (errno != EINTR && errno != ECONNABORTED) { this_thread::sleep_for(chrono::milliseconds(10)); } // e.g. out of descriptors
+         continue;
+      }
+      {
+         lock_guard<mutex> lock(clientsLock);
+         clients.push_back(fd);
+      }
+      serve(fd, fd);
+      {
+         lock_guard<mutex> lock(clientsLock);
+         clients.erase(find(clients.begin(), clients.end(), fd));
+      }
+      close(fd);
+   }
+}
+
+/**
+	Listen on a Unix socket at path and serve clients on threads worker
+	threads, each taking one connection at a time, until a client sends
+	shutdown. A socket left at path by a server that is no longer running
+	is replaced; anything else there is an error. Returns false with a
+	reason in error if the socket could not be set up.
+ */
+bool ChainServer::listen(const string& path, int threads, string& error) {
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+      error = "socket path is empty or too long";
+      return false;
+   }
+   memcpy(address.sun_path, path.data(), path.size());
+
+   struct stat info;
+   if (lstat(path.c_str(), &info) == 0) {
+      if (!S_ISSOCK(info.st_mode)) {
+         error = path + " exists and is not a socket";
+         return false;
+      }
+      int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+      bool live = probe >= 0 && connect(probe, (sockaddr*)&address, sizeof(address)) == 0;
+      if (probe >= 0) { close(probe); }
+      if (live) {
+         error = path + " is in use by another server";
+         return false;
+      }
+      unlink(path.c_str());
+   }
+
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0 || bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+      error = strerror(errno);
+      if (fd >= 0) { close(fd); }
+      return false;
+   }
+   signal(SIGPIPE, SIG_IGN); // a client hanging up must not end the server
+   listener = fd;
+
+   vector<thread> workers;
+   for (int t = 0; t < max(threads, 1); t++) { workers.push_back(thread(&ChainServer::acceptClients, this)); }
+   for (size_t t = 0; t < workers.size(); t++) { workers[t].join(); }
+
+   {
+      lock_guard<mutex> lock(clientsLock);
+      listener = -1;
+   }
+   close(fd);
+   unlink(path.c_str());
+   return true;
+}
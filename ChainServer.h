@@ -0,0 +1,74 @@
+/**
+	@name ChainServer.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+
+	Answers queries about a finished ChainSet, for --serve. Everything a
+	query needs is built once up front: a reverse index from each word to
+	the chains holding it and the longest of them, another to the chains
+	ending at it, and a trie
+	over the vocabulary. A query then touches only the words and chains it
+	names, never the whole set.
+
+	Clients send one command per line and get one JSON object per line
+	back, on standard input and output or over a Unix socket whose
+	connections are taken by a fixed pool of threads. Each command's
+	service time is kept in a histogram that the stats command reports.
+ */
+
+#ifndef CHAINSERVER_H_
+#define CHAINSERVER_H_
+
+#include "ChainBuilder.h"
+#include "ReportWriter.h"
+#include "WordTrie.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// commands with a latency histogram, in the order stats reports them
+enum ServerCommand { SERVE_CHAINS, SERVE_LONGEST, SERVE_NEIGHBORS, SERVE_CHAIN, SERVE_STATS, SERVE_COMMANDS };
+
+class ChainServer {
+ public:
+   // bucket b counts service times of under 2^b nanoseconds and at least half that
+   static const int LATENCY_BUCKETS = 40;
+
+ private:
+   const ChainSet& set;
+   WordTrie trie;
+   vector<uint32_t> memberStart;  // chains holding word w are members[memberStart[w] .. memberStart[w+1]), in order
+   vector<int> members;
+   vector<uint32_t> endStart;     // chains with an end at word w, likewise
+   vector<int> ends;
+   vector<int> longest;           // by word: the longest chain holding it, the first of equals, or -1
+   chrono::steady_clock::time_point started;
+
+   atomic<uint64_t> latency[SERVE_COMMANDS][LATENCY_BUCKETS];
+   atomic<uint64_t> latencyTotal[SERVE_COMMANDS];  // nanoseconds, for the mean
+   atomic<bool> stopping;
+   int listener;
+   mutex clientsLock;
+   vector<int> clients;           // connections being served, woken on shutdown
+
+   ChainServer(const ChainServer&);
+   ChainServer& operator=(const ChainServer&);
+
+   bool answer(string_view line, ReportWriter& out, bool& shutdown);
+   void record(ServerCommand command, chrono::steady_clock::time_point start);
+   void writeChain(int chain, ReportWriter& out) const;
+   void writeStats(ReportWriter& out) const;
+   void stop();
+   void acceptClients();
+
+ public:
+   explicit ChainServer(const ChainSet& chains);
+
+   void serve(int in, int out);
+   bool listen(const string& path, int threads, string& error);
+
+   size_t bytes() const;
+};
+
+#endif
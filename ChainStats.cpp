@@ -0,0 +1,114 @@
+/** 	
+	@name ChainStats.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Statistics kept up to date while chains are built.
+ */
+
+#include "ChainStats.h"
+#include <algorithm>
+
+ChainStats::ChainStats()
+ : longestChain(0), longestWord(0), words(0), uniqueWords(0) { }
+
+/**
+	Record one word added to chain: its length, whether it is the
+	longest so far, and whether it has been seen before.
+ */
+void ChainStats::countWord(uint32_t word, size_t length, int chain) {
+   words++;
+   if (length >= wordLengths.size()) { wordLengths.resize(length + 1, 0); }
+   wordLengths[length]++;
+
+   if (word >= seen.size()) { seen.resize(max<size_t>(word + 1, 2 * seen.size()), false); }
+   if (!seen[word]) { seen[word] = true; uniqueWords++; }
+
+   if (length > longestWord) {
+      longestWord = length;
+      wordChains.assign(1, chain);
+   } else if (length == longestWord) {
+      wordChains.push_back(chain);
+   }
+}
+
+/**
+	A chain was created holding only word.
+ */
+void ChainStats::newChain(int chain, uint32_t word, size_t length) {
+   if (chainLengths.size() < 2) { chainLengths.resize(2, 0); }
+   chainLengths[1]++;
+   if (longestChain < 1) {
+      longestChain = 1;
+      longestChains.clear();
+   }
+   if (longestChain == 1) { longestChains.push_back(chain); }
+   countWord(word, length, chain);
+}
+
+/**
+	Chain grew to chainLength words by taking word at one end.
+ */
+void ChainStats::grewChain(int chain, size_t chainLength, uint32_t word, size_t length) {
+   if (chainLength >= chainLengths.size()) { chainLengths.resize(chainLength + 1, 0); }
+   chainLengths[chainLength - 1]--;
+   chainLengths[chainLength]++;
+   if (chainLength > longestChain) {
+      longestChain = chainLength;
+      longestChains.assign(1, chain);
+   } else if (chainLength == longestChain) {
+      longestChains.push_back(chain);
+   }
+   countWord(word, length, chain);
+}
+
+/**
+	Fold in the statistics of chains that were built separately and
+	appended after chain offset - 1.
+ */
+void ChainStats::merge(const ChainStats& other, int offset) {
+   if (other.longestChain > longestChain) {
+      longestChain = other.longestChain;
+      longestChains.clear();
+   }
+   if (other.longestChain == longestChain) {
+      for (size_t k = 0; k < other.longestChains.size(); k++) { longestChains.push_back(other.longestChains[k] + offset); }
+   }
+   if (other.longestWord > longestWord) {
+      longestWord = other.longestWord;
+      wordChains.clear();
+   }
+   if (other.longestWord == longestWord) {
+      for (size_t k = 0; k < other.wordChains.size(); k++) { wordChains.push_back(other.wordChains[k] + offset); }
+   }
+
+   if (other.chainLengths.size() > chainLengths.size()) { chainLengths.resize(other.chainLengths.size(), 0); }
+   for (size_t k = 0; k < other.chainLengths.size(); k++) { chainLengths[k] += other.chainLengths[k]; }
+   if (other.wordLengths.size() > wordLengths.size()) { wordLengths.resize(other.wordLengths.size(), 0); }
+   for (size_t k = 0; k < other.wordLengths.size(); k++) { wordLengths[k] += other.wordLengths[k]; }
+
+   if (other.seen.size() > seen.size()) { seen.resize(other.seen.size(), false); }
+   for (size_t k = 0; k < other.seen.size(); k++) {
+      if (other.seen[k] && !seen[k]) { seen[k] = true; uniqueWords++; }
+   }
+   words += other.words;
+}
+
+/**
+	Chains of the longest length, in chain order.
+ */
+vector<int> ChainStats::longestChainIndexes() const {
+   vector<int> v(longestChains);
+   sort(v.begin(), v.end());
+   return v;
+}
+
+/**
+	Chains holding at least one word of the longest length, in chain order.
+ */
+vector<int> ChainStats::longestWordChains() const {
+   vector<int> v(wordChains);
+   sort(v.begin(), v.end());
+   v.erase(unique(v.begin(), v.end()), v.end());
+   return v;
+}
@@ -0,0 +1,51 @@
+/** 	
+	@name ChainStats.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Statistics kept up to date while chains are built: the longest
+	chains, the chains holding the longest words, chain-length and
+	word-length histograms and word counts. Reports read them directly
+	instead of walking every chain again.
+ */
+
+#ifndef CHAINSTATS_H_
+#define CHAINSTATS_H_
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace std;
+
+class ChainStats {
+   size_t longestChain;       // words in the longest chain
+   vector<int> longestChains; // chains of that length, in the order they reached it
+   size_t longestWord;        // letters in the longest word
+   vector<int> wordChains;    // chains holding a word of that length, possibly repeated
+   vector<size_t> chainLengths;
+   vector<size_t> wordLengths;
+   vector<bool> seen;         // by word id
+   size_t words;
+   size_t uniqueWords;
+
+   void countWord(uint32_t word, size_t length, int chain);
+
+ public:
+   ChainStats();
+
+   void newChain(int chain, uint32_t word, size_t length);
+   void grewChain(int chain, size_t chainLength, uint32_t word, size_t length);
+   void merge(const ChainStats& other, int offset);
+
+   size_t longestChainLength() const { return longestChain; }
+   vector<int> longestChainIndexes() const;
+   size_t longestWordLength() const { return longestWord; }
+   vector<int> longestWordChains() const;
+   const vector<size_t>& chainLengthHistogram() const { return chainLengths; }
+   const vector<size_t>& wordLengthHistogram() const { return wordLengths; }
+   size_t wordCount() const { return words; }
+   size_t uniqueWordCount() const { return uniqueWords; }
+};
+
+#endif
@@ -0,0 +1,225 @@
+/** 	
+	@name ChainStream.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Incremental chain building over an unbounded word stream with a cap
+	on memory.
+ */
+
+#include "ChainStream.h"
+#include <algorithm>
+
+ChainStream::ChainStream(bool allowDuplicate, bool stepGrowth, size_t memoryLimit, size_t topCount, Metric metric)
+ : allowDuplicate(allowDuplicate), stepGrowth(stepGrowth), place(selectPlacer(metric, allowDuplicate, stepGrowth)),
+   memoryLimit(memoryLimit), topCount(topCount),
+   wordsRead(0), liveChains(0), liveWords(0), retiredChains(0), rankedBytes(0), longestLength(0) { }
+
+ChainStream::~ChainStream() {
+   for (size_t i = 0; i < chains.size(); i++) { delete chains[i]; }
+}
+
+/**
+	Add the next word of the stream to a chain, then retire chains if the
+	memory cap has been passed. The cap is checked every 4096 words; the
+	chain that took the word is retired at once if it has reached
+	chainLimit(), and words that would have extended it start anew.
+ */
+void ChainStream::add(string_view word) {
+   wordsRead++;
+
+   if (word.size() > longestLength) {
+      longestLength = word.size();
+      longestWords.assign(1, string(word));
+   } else if (word.size() == longestLength && longestWords.size() < topCount
+              && find(longestWords.begin(), longestWords.end(), word) == longestWords.end()) {
+      longestWords.push_back(string(word));
+   }
+
+   size_t i = place(pool.intern(word), chains, index, pool, NULL, NULL);
+   if (i == grown.size()) { // a new chain
+      grown.push_back(wordsRead);
+      liveChains++;
+   } else {
+      grown[i] = wordsRead;
+   }
+   liveWords++;
+
+   if (chains[i]->size() >= chainLimit()) {
+      keepLongest(vector<uint32_t>(1, i));
+      drop(i);
+   }
+   if (wordsRead % 4096 == 0 && bytes() > memoryLimit) {
+      retire();
+   }
+}
+
+/**
+	Approximate heap in use: the word pool, the endpoint index, the live
+	chains (their words, and their member sets without duplicates) and
+	the text of the retired chains kept for the top-K list.
+ */
+size_t ChainStream::bytes() const {
+   return pool.bytes() + index.bytes()
+        + chains.capacity() * sizeof(Chain*) + grown.capacity() * sizeof(uint64_t)
+        + liveChains * sizeof(Chain) + liveWords * wordBytes() + rankedBytes;
+}
+
+/**
+	Most words one chain may hold: an eighth of the cap, shared among the
+	top-K slots, since each chain retired for reaching it may be kept in
+	the list as text. No single chain can then hold the stream over the
+	cap, and the list stays well under it.
+ */
+size_t ChainStream::chainLimit() const {
+   return max<size_t>(2, memoryLimit / 8 / max<size_t>(topCount, 1) / wordBytes());
+}
+
+/**
+	Insert chain into ranking (longest first, at most topCount long) if it
+	is long enough to belong there.
+ */
+void ChainStream::rank(vector<RankedChain>& ranking, const Chain* chain) const {
+   size_t length = chain->size();
+   if (ranking.size() == topCount && (topCount == 0 || ranking.back().length >= length)) { return; }
+
+   RankedChain entry = { length, chain->toString() };
+   vector<RankedChain>::iterator at = ranking.begin();
+   while (at != ranking.end() && at->length >= length) { at++; }
+   ranking.insert(at, entry);
+   if (ranking.size() > topCount) { ranking.pop_back(); }
+}
+
+/**
+	Offer the chains ids names to ranking, in that order, with the result
+	rank() would give offering each in turn. Only the topCount longest
+	(the earliest of equals) can end up in the list, so only those are
+	offered and spelled out.
+ */
+void ChainStream::rankLongest(vector<RankedChain>& ranking, const vector<uint32_t>& ids) const {
+   vector<uint32_t> order(ids.size());
+   for (uint32_t k = 0; k < order.size(); k++) { order[k] = k; }
+   size_t offered = min(order.size(), topCount);
+   partial_sort(order.begin(), order.begin() + offered, order.end(), [&](uint32_t a, uint32_t b) {
+      size_t lengthA = chains[ids[a]]->size();
+      size_t lengthB = chains[ids[b]]->size();
+      return lengthA != lengthB ? lengthA > lengthB : a < b;
+   });
+   for (size_t k = 0; k < offered; k++) { rank(ranking, chains[ids[order[k]]]); }
+}
+
+/**
+	Offer chains about to be retired to the top-K list, and account for
+	the text it holds.
+ */
+void ChainStream::keepLongest(const vector<uint32_t>& ids) {
+   rankLongest(retiredTop, ids);
+   rankedBytes = 0;
+   for (size_t k = 0; k < retiredTop.size(); k++) { rankedBytes += retiredTop[k].text.capacity(); }
+}
+
+/**
+	Free live chain i and take its ends out of the index. Its slot stays
+	empty until the next compact().
+ */
+void ChainStream::drop(uint32_t i) {
+   Chain* chain = chains[i];
+   index.erase(pool.str(chain->returnFront()), i, FRONT);
+   index.erase(pool.str(chain->returnRear()), i, REAR);
+   liveWords -= chain->size();
+   liveChains--;
+   retiredChains++;
+   delete chain;
+   chains[i] = NULL;
+}
+
+/**
+	Retire the half of the live chains that went longest without growing.
+	A chain that has not matched a word for that long is unlikely to match
+	again. Retired chains are offered to the top-K list and freed. The
+	survivors are compacted only once at least half the pool and half the
+	chain slots are dead, so the cost of rebuilding is paid for by the
+	memory it returns rather than by every retirement.
+ */
+void ChainStream::retire() {
+   vector<uint32_t> live;
+   for (uint32_t i = 0; i < chains.size(); i++) {
+      if (chains[i]) { live.push_back(i); }
+   }
+   sort(live.begin(), live.end(), [&](uint32_t a, uint32_t b) { return grown[a] < grown[b]; });
+   live.resize((live.size() + 1) / 2);
+
+   keepLongest(live);
+   for (size_t k = 0; k < live.size(); k++) { drop(live[k]); }
+
+   if (pool.size() > 2 * liveWords || chains.size() > 2 * liveChains) {
+      compact();
+   }
+}
+
+/**
+	Renumber the live chains in their original order, re-intern only the
+	words they still hold and rebuild the endpoint index, so memory used
+	by retired chains and forgotten words is returned.
+ */
+void ChainStream::compact() {
+   WordPool kept;
+   vector<vector<uint32_t> > words;
+   vector<uint64_t> keptGrown;
+   for (size_t i = 0; i < chains.size(); i++) {
+      if (!chains[i]) { continue; }
+      words.push_back(vector<uint32_t>());
+      for (size_t k = 0; k < chains[i]->size(); k++) {
+         words.back().push_back(kept.intern(pool.str(chains[i]->item(k))));
+      }
+      keptGrown.push_back(grown[i]);
+      delete chains[i];
+   }
+
+   pool = kept;
+   index = EndpointIndex();
+   vector<Chain* >().swap(chains);
+   grown.swap(keptGrown);
+
+   for (size_t i = 0; i < words.size(); i++) {
+      Chain* chain = new Chain(&pool, !allowDuplicate);
+      for (size_t k = 0; k < words[i].size(); k++) { chain->pushRear(words[i][k]); }
+      chains.push_back(chain);
+      index.insert(pool.str(chain->returnFront()), chain->returnFront(), i, FRONT);
+      index.insert(pool.str(chain->returnRear()), chain->returnRear(), i, REAR);
+   }
+}
+
+/**
+	Print the running results: counts, memory, the longest chains and the
+	longest words seen so far.
+ */
+void ChainStream::snapshot(ostream& out) const {
+   vector<RankedChain> top = retiredTop;
+   vector<uint32_t> live;
+   for (uint32_t i = 0; i < chains.size(); i++) {
+      if (chains[i]) { live.push_back(i); }
+   }
+   rankLongest(top, live);
+
+   out << "----------------------------------------------" << endl;
+   out << "                STREAM SNAPSHOT               " << endl;
+   out << "----------------------------------------------" << endl;
+   out << "Words read: " << wordsRead << endl;
+   out << "Live chains: " << liveChains << " (" << liveWords << " words)" << endl;
+   out << "Retired chains: " << retiredChains << endl;
+   out << "Approximate memory: " << bytes() << " bytes" << endl;
+   out << endl;
+   out << "The longest chain(s) so far are: " << endl;
+   for (size_t k = 0; k < top.size(); k++) {
+      out << "    " << top[k].length << " words: " << top[k].text << endl;
+   }
+   out << endl;
+   out << "The longest string(s) so far are: ";
+   for (size_t k = 0; k < longestWords.size(); k++) {
+      out << (k ? ", " : "") << longestWords[k];
+   }
+   out << endl;
+   out << "The length of the longest string(s) are: " << longestLength << endl;
+   out << endl;
+}
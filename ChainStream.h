@@ -0,0 +1,69 @@
+/** 	
+	@name ChainStream.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Incremental chain building over an unbounded word stream with a cap
+	on memory. Chains that have stopped growing are retired once the cap
+	is reached, a chain that keeps growing is retired once it holds its
+	share of the cap, and the longest chains and words seen so far are
+	kept as running results that can be reported at any time.
+ */
+
+#ifndef CHAINSTREAM_H_
+#define CHAINSTREAM_H_
+
+#include "ChainBuilder.h"
+#include <ostream>
+
+/**
+	A chain kept for the running top-K list, with its words spelled out.
+ */
+struct RankedChain {
+   size_t length;
+   string text;
+};
+
+class ChainStream {
+   WordPool pool;
+   vector<Chain* > chains;       // NULL once a chain has been retired
+   vector<uint64_t> grown;       // wordsRead when each chain last received a word
+   EndpointIndex index;
+   bool allowDuplicate;
+   bool stepGrowth;
+   WordPlacer place;
+   size_t memoryLimit;
+   size_t topCount;
+
+   uint64_t wordsRead;
+   size_t liveChains;
+   size_t liveWords;
+   uint64_t retiredChains;
+   vector<RankedChain> retiredTop;   // longest retired chains, longest first
+   size_t rankedBytes;               // text held by retiredTop
+   size_t longestLength;
+   vector<string> longestWords;
+
+   ChainStream(const ChainStream&);
+   ChainStream& operator=(const ChainStream&);
+
+   void retire();
+   void keepLongest(const vector<uint32_t>& ids);
+   void drop(uint32_t i);
+   void compact();
+   void rank(vector<RankedChain>& ranking, const Chain* chain) const;
+   void rankLongest(vector<RankedChain>& ranking, const vector<uint32_t>& ids) const;
+   size_t wordBytes() const { return sizeof(uint32_t) * (allowDuplicate ? 1 : 3); }
+   size_t chainLimit() const;
+
+ public:
+   ChainStream(bool allowDuplicate, bool stepGrowth, size_t memoryLimit, size_t topCount, Metric metric = EDIT);
+   ~ChainStream();
+
+   void add(string_view word);
+   uint64_t count() const { return wordsRead; }
+   size_t bytes() const;
+   void snapshot(ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,253 @@
+/** 	
+	@name EditDistance.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Distance-one tests between words, built on a vectorized mismatch
+	kernel chosen at run time.
+ */
+
+#include "EditDistance.h"
+#include "Profile.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+
+typedef size_t (*MismatchFn)(const char* a, const char* b, size_t n);
+
+/**
+	Index of the first i < n with a[i] != b[i], or n if there is none.
+ */
+static size_t mismatchScalar(const char* a, const char* b, size_t n) {
+   size_t i = 0;
+   while (i < n && a[i] == b[i]) { i++; }
+   return i;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+/**
+	Load width bytes from p, of which only the first n < width are
+	wanted. Reading past the end is harmless as long as it stays on the
+	same page; otherwise the tail is copied into a zeroed buffer. The
+	unwanted lanes are masked off by the caller.
+ */
+static inline bool tailFitsPage(const char* p, size_t width) {
+   return ((uintptr_t)p & 4095) <= 4096 - width;
+}
+
+__attribute__((target("sse2")))
+static size_t mismatchSse2(const char* a, const char* b, size_t n) {
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+      __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+      unsigned m = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFF;
+      if (m) { return i + __builtin_ctz(m); }
+   }
+   size_t rest = n - i;
+   if (rest == 0) { return n; }
+
+   __m128i x, y;
+   if (tailFitsPage(a + i, 16) && tailFitsPage(b + i, 16)) {
+      x = _mm_loadu_si128((const __m128i*)(a + i));
+      y = _mm_loadu_si128((const __m128i*)(b + i));
+   } else {
+      char bufA[16] = { 0 }, bufB[16] = { 0 };
+      memcpy(bufA, a + i, rest);
+      memcpy(bufB, b + i, rest);
+      x = _mm_loadu_si128((const __m128i*)bufA);
+      y = _mm_loadu_si128((const __m128i*)bufB);
+   }
+   unsigned m = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & ((1u << rest) - 1);
+   return m ? i + __builtin_ctz(m) : n;
+}
+
+__attribute__((target("avx2")))
+static size_t mismatchAvx2(const char* a, const char* b, size_t n) {
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+      __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+      unsigned m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+      if (m) { return i + __builtin_ctz(m); }
+   }
+   size_t rest = n - i;
+   if (rest == 0) { return n; }
+
+   __m256i x, y;
+   if (tailFitsPage(a + i, 32) && tailFitsPage(b + i, 32)) {
+      x = _mm256_loadu_si256((const __m256i*)(a + i));
+      y = _mm256_loadu_si256((const __m256i*)(b + i));
+   } else {
+      char bufA[32] = { 0 }, bufB[32] = { 0 };
+      memcpy(bufA, a + i, rest);
+      memcpy(bufB, b + i, rest);
+      x = _mm256_loadu_si256((const __m256i*)bufA);
+      y = _mm256_loadu_si256((const __m256i*)bufB);
+   }
+   unsigned m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) & (unsigned)((1ull << rest) - 1);
+   return m ? i + __builtin_ctz(m) : n;
+}
+
+#endif
+
+static const char* kernelName = "scalar";
+
+/**
+	Pick the widest kernel this CPU supports.
+ */
+static MismatchFn selectKernel() {
+#ifdef HAVE_X86_KERNELS
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2")) { kernelName = "avx2"; return mismatchAvx2; }
+   if (__builtin_cpu_supports("sse2")) { kernelName = "sse2"; return mismatchSse2; }
+#endif
+   return mismatchScalar;
+}
+
+static const MismatchFn firstMismatch = selectKernel();
+
+/**
+	Name of the kernel in use: "avx2", "sse2" or "scalar".
+ */
+const char* editDistanceKernel() {
+   return kernelName;
+}
+
+/**
+	Strings of equal length n differ in exactly one position.
+ */
+static inline bool sameLength1(const char* a, const char* b, size_t n) {
+   size_t p = firstMismatch(a, b, n);
+   if (p == n) { return false; } // equal strings
+   p++;
+   return firstMismatch(a + p, b + p, n - p) == n - p;
+}
+
+/**
+	longer (n+1 chars) is shorter (n chars) with one character inserted.
+	Everything before the first mismatch matches, so the rest of longer
+	must equal the rest of shorter shifted by one.
+ */
+static inline bool oneInsert(const char* longer, const char* shorter, size_t n) {
+   size_t p = firstMismatch(longer, shorter, n);
+   return p == n || firstMismatch(longer + p + 1, shorter + p, n - p) == n - p;
+}
+
+/** 
+	Strings lhs and rhs have Hamming distance 1
+ */
+bool hd1(string_view lhs, string_view rhs) {
+   if (lhs.size() != rhs.size()) { return false; }
+   return sameLength1(lhs.data(), rhs.data(), lhs.size());
+}
+
+/** Strings lhs and rhs have extension distance 1
+    Equal lengths reduce to hd1. Otherwise the longer string must be the
+    shorter one with a single character added at the beginning or the end.
+ */
+bool xd1(string_view lhs, string_view rhs) {
+   if (lhs.size() == rhs.size()) { 
+      return hd1(lhs,rhs); 
+   }
+   if (lhs.size() < rhs.size()) { lhs.swap(rhs); }
+   if (lhs.size() != 1 + rhs.size()) { return false; } //strings differ by 2 or more in length.
+
+   size_t n = rhs.size();
+   return firstMismatch(lhs.data(), rhs.data(), n) == n || firstMismatch(lhs.data() + 1, rhs.data(), n) == n;
+}
+
+/** 
+	Checks if two strings have edit distance 1.
+ */
+bool ed1(string_view lhs, string_view rhs) {
+   if (lhs.size() == rhs.size()) {
+      return sameLength1(lhs.data(), rhs.data(), lhs.size());
+   } else if (lhs.size() == 1 + rhs.size()) {  //check for delete in first string
+      return oneInsert(lhs.data(), rhs.data(), rhs.size());
+   } else if (1 + lhs.size() == rhs.size()) {  //check for delete in second string
+      return oneInsert(rhs.data(), lhs.data(), lhs.size());
+   } else {
+      return false;
+   }
+}
+
+/**
+	Build the match masks: bit i of masks[c] is set when the word's
+	i-th character is letter c.
+ */
+EditPattern::EditPattern(string_view word)
+ : pattern(word), last(0), bitParallel(!word.empty() && word.size() <= 64)
+{
+   for (int c = 0; c < 27; c++) { masks[c] = 0; }
+   for (size_t i = 0; i < word.size() && bitParallel; i++) {
+      unsigned letter = (unsigned char)word[i] - 'a';
+      if (letter >= 26) { bitParallel = false; break; }
+      masks[letter] |= (uint64_t)1 << i;
+   }
+   if (bitParallel) { last = (uint64_t)1 << (word.size() - 1); }
+}
+
+/**
+	Hyyrö's form of Myers' recurrence for the distance between the whole
+	pattern and the whole text. VP and VN hold the vertical +1 and -1
+	differences of the current column of the dynamic programming table
+	and score its bottom cell. The carry into row 0 is always +1, since
+	row 0 of column j is j. The scan stops as soon as the characters
+	left could no longer bring the score back down to 1.
+ */
+bool EditPattern::distance1(const char* text, size_t n) const {
+   uint64_t vp = ~(uint64_t)0;
+   uint64_t vn = 0;
+   size_t score = pattern.size();
+   for (size_t j = 0; j < n; j++) {
+      unsigned letter = (unsigned char)text[j] - 'a';
+      uint64_t eq = masks[letter < 26 ? letter : 26];
+      uint64_t xv = eq | vn;
+      uint64_t xh = (((eq & vp) + vp) ^ vp) | eq;
+      uint64_t ph = vn | ~(xh | vp);
+      uint64_t mh = vp & xh;
+      if (ph & last) {
+         score++;
+      } else if (mh & last) {
+         score--;
+      }
+      if (score > 1 + (n - j - 1)) { return false; }
+      ph = (ph << 1) | 1;
+      mh <<= 1;
+      vp = mh | ~(xv | ph);
+      vn = ph & xv;
+   }
+   return score == 1;
+}
+
+/**
+	Test the pattern against count packed candidates and append the
+	index of each one at edit distance one to matches. Candidate k is the
+	offsets[k + 1] - offsets[k] - 1 bytes at chars + offsets[k], the
+	layout a WordPool keeps its words in (each followed by one separator),
+	so lengths are read from the offsets alone and candidates more than
+	one letter longer or shorter are passed over without touching their
+	characters. Returns the number of matches.
+ */
+size_t EditPattern::screen(const char* chars, const uint32_t* offsets, size_t count, vector<uint32_t>& matches) const {
+   size_t before = matches.size();
+   size_t m = pattern.size();
+   size_t tested = 0;
+   for (size_t k = 0; k < count; k++) {
+      size_t n = offsets[k + 1] - offsets[k] - 1;
+      if (n + 1 < m || n > m + 1) { continue; }
+      tested++;
+      const char* text = chars + offsets[k];
+      if (bitParallel ? distance1(text, n) : ed1(pattern, string_view(text, n))) {
+         matches.push_back(k);
+      }
+   }
+   profileCount(DISTANCE_TESTS, tested);
+   return matches.size() - before;
+}
@@ -0,0 +1,82 @@
+/** 	
+	@name EditDistance.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Distance-one tests between words. All of them reduce to a "first
+	mismatching byte" kernel that compares 16 (SSE2) or 32 (AVX2) bytes
+	at a time; the widest kernel the CPU supports is picked once at
+	start-up, with a scalar loop as the fallback. None of them allocate.
+
+	EditPattern answers the same edit-distance question for one word
+	against many: it holds the word's Myers/Hyyrö match masks, built
+	once, and runs the bit-parallel distance recurrence with k = 1 over
+	each candidate. It serves --neighbors, which screens the whole pool
+	for one word; chain placement and --serve find neighbors through a
+	WordTrie and run no distance tests at all.
+ */
+
+#ifndef EDITDISTANCE_H_
+#define EDITDISTANCE_H_
+
+#include <string_view>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace std;
+
+bool hd1(string_view lhs, string_view rhs);
+bool xd1(string_view lhs, string_view rhs);
+bool ed1(string_view lhs, string_view rhs);
+
+/**
+	One word compiled for repeated edit distance one tests. Words of 1
+	to 64 letters a-z get a bit mask per letter marking where it occurs,
+	and each candidate then costs one pass of word-wide bit operations
+	per character; any other word falls back to ed1().
+*/
+class EditPattern {
+   string_view pattern;
+   uint64_t masks[27];   // by letter; masks[26] stays 0 for any other byte
+   uint64_t last;        // bit of the pattern's final character
+   bool bitParallel;
+
+   bool distance1(const char* text, size_t n) const;
+
+ public:
+   explicit EditPattern(string_view word);
+
+	/**
+		Whether ed1(word, candidate) holds.
+	*/
+   bool within1(string_view candidate) const {
+      size_t n = candidate.size();
+      if (n + 1 < pattern.size() || n > pattern.size() + 1) { return false; }
+      return bitParallel ? distance1(candidate.data(), n) : ed1(pattern, candidate);
+   }
+
+   size_t screen(const char* chars, const uint32_t* offsets, size_t count, vector<uint32_t>& matches) const;
+};
+
+/**
+	Distance policies for code templated on the metric. Each names its
+	Metric, which selects the neighbors an EndpointIndex lookup returns.
+*/
+enum Metric { EDIT = 0, HAMMING = 1, EXTENSION = 2 };
+
+struct HammingDistance {
+   static const Metric METRIC = HAMMING;
+};
+
+struct ExtensionDistance {
+   static const Metric METRIC = EXTENSION;
+};
+
+struct LevenshteinDistance {
+   static const Metric METRIC = EDIT;
+};
+
+const char* editDistanceKernel();
+
+#endif
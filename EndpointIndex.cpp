@@ -0,0 +1,134 @@
+/** 	
+	@name EndpointIndex.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Index over the front and rear words of every live chain.
+	
+	Each word keeps the chains it is the front of and the chains it is
+	the rear of in ascending order. New chains always have the highest
+	number, so filing an end is usually an append, and the lowest chain
+	at a word is the first entry of its list.
+	
+	The chain a word joins is the lowest numbered one with an end at
+	distance one, its front winning over its rear. With step growth that
+	end must also point the right way: a front one letter shorter (the
+	word goes before it) or a rear one letter longer (the word goes after
+	it). Any other end below it blocks the word, which then starts a new
+	chain. So first() looks at the shorter and longer neighbors first;
+	if none offers a usable end, the word starts a new chain without the
+	same-length neighbors ever being listed, and otherwise only list
+	heads below the usable end are compared. A bucket is left out of the
+	walk altogether when no end is filed at its length.
+ */
+
+#include "EndpointIndex.h"
+#include "Profile.h"
+#include <algorithm>
+
+static const uint32_t NONE = 0xFFFFFFFF;
+
+/**
+	File one end of a chain under its word.
+ */
+void EndpointIndex::insert(string_view word, uint32_t id, int chain, ChainEnd end) {
+   words.insert(word, id);
+   size_t list = 2 * (size_t)id + end;
+   if (list >= ends.size()) { ends.resize(max<size_t>(2 * ends.size(), list + 2)); }
+
+   vector<int>& chains = ends[list];
+   if (chains.empty() || chains.back() < chain) {
+      chains.push_back(chain);
+   } else {
+      chains.insert(lower_bound(chains.begin(), chains.end(), chain), chain);
+   }
+   if (word.size() >= byLength.size()) { byLength.resize(word.size() + 1, 0); }
+   byLength[word.size()]++;
+   entries++;
+}
+
+/**
+	Remove a chain end previously filed with insert().
+ */
+void EndpointIndex::erase(string_view word, int chain, ChainEnd end) {
+   uint32_t id = words.find(word);
+   if (id == WordTrie::NOT_FOUND || 2 * (size_t)id + end >= ends.size()) { return; }
+
+   vector<int>& chains = ends[2 * (size_t)id + end];
+   vector<int>::iterator at = lower_bound(chains.begin(), chains.end(), chain);
+   if (at != chains.end() && *at == chain) {
+      chains.erase(at);
+      byLength[word.size()]--;
+      entries--;
+   }
+}
+
+/**
+	Lowest chain with this end at word, or -1.
+ */
+inline int EndpointIndex::head(uint32_t word, ChainEnd end) const {
+   size_t list = 2 * (size_t)word + end;
+   if (list >= ends.size() || ends[list].empty()) { return -1; }
+   profileCount(CANDIDATES);
+   return ends[list].front();
+}
+
+/**
+	The chain end word joins: the lowest numbered chain with an end at
+	distance one under metric, front before rear. With stepGrowth the
+	end is only returned if the word may be added there. Returns chain
+	-1 when the word should start a new chain.
+ */
+Endpoint EndpointIndex::first(string_view word, Metric metric, bool stepGrowth) const {
+   thread_local vector<uint32_t> near;
+   uint32_t best = NONE;     // lowest 2 * chain + end the word may join
+   uint32_t blocked = NONE;  // lowest 2 * chain + end it may not
+   Endpoint none = { -1, FRONT };
+   unsigned live = liveLengths(word.size());
+
+   // with step growth a shorter neighbor can only be a front and a longer one only a rear
+   unsigned buckets[2] = { WordTrie::SHORTER, WordTrie::LONGER };
+   for (int b = 0; b < (stepGrowth ? 2 : 1); b++) {
+      unsigned lengths = (stepGrowth ? buckets[b] : (unsigned)WordTrie::ANY_LENGTH) & live;
+      if (lengths == 0) { continue; }
+      near.clear();
+      words.neighbors(word, metric, near, lengths);
+      profileCount(NEIGHBORS, near.size());
+      for (size_t k = 0; k < near.size(); k++) {
+         for (int end = FRONT; end <= REAR; end++) {
+            int chain = head(near[k], ChainEnd(end));
+            if (chain < 0) { continue; }
+            uint32_t slot = 2 * (uint32_t)chain + end;
+            if (!stepGrowth || (buckets[b] == WordTrie::SHORTER) == (end == FRONT)) {
+               best = min(best, slot);
+            } else {
+               blocked = min(blocked, slot);
+            }
+         }
+      }
+   }
+
+   if (stepGrowth && best != NONE && (live & WordTrie::SAME_LENGTH)) { // same-length ends below best block it too
+      near.clear();
+      words.neighbors(word, metric, near, WordTrie::SAME_LENGTH);
+      profileCount(NEIGHBORS, near.size());
+      for (size_t k = 0; k < near.size() && blocked > best; k++) {
+         for (int end = FRONT; end <= REAR; end++) {
+            int chain = head(near[k], ChainEnd(end));
+            if (chain >= 0) { blocked = min(blocked, 2 * (uint32_t)chain + end); }
+         }
+      }
+   }
+
+   if (best == NONE || blocked < best) { return none; }
+   Endpoint e = { (int)(best / 2), ChainEnd(best & 1) };
+   return e;
+}
+
+/**
+	Approximate heap held by the index: the trie, the per-word lists and
+	the filed ends.
+ */
+size_t EndpointIndex::bytes() const {
+   return words.bytes() + ends.capacity() * sizeof(vector<int>) + entries * sizeof(int) + byLength.capacity() * sizeof(uint32_t);
+}
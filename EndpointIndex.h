@@ -0,0 +1,113 @@
+/** 	
+	@name EndpointIndex.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Index over the front and rear words of every live chain. Every word
+	ever filed goes into a WordTrie, and each word keeps two sorted lists:
+	the chains it is the front of and the chains it is the rear of. The
+	chain ends within distance one of a new word are found by listing the
+	word's neighbors in the trie and reading their lists, so a lookup
+	costs time in the length of the word and the number of neighboring
+	words, however many chains share an end word.
+	
+	Neighbors fall into three length buckets: one letter shorter, the
+	same length, one letter longer. With step growth a word may only go
+	in front of a shorter front or behind a longer rear, which lets
+	first() skip most of the lookup, see EndpointIndex.cpp. The index
+	also counts the filed ends of each word length, so a bucket with no
+	live end at its length is never walked.
+ */
+
+#ifndef ENDPOINTINDEX_H_
+#define ENDPOINTINDEX_H_
+
+#include "WordTrie.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+enum ChainEnd { FRONT = 0, REAR = 1 };
+
+struct Endpoint {
+   int chain;
+   ChainEnd end;
+};
+
+class EndpointIndex {
+   WordTrie words;                  // every word filed so far, under the caller's id
+   vector<vector<int> > ends;       // by 2 * word id + end: the chains with that end there, ascending
+   vector<uint32_t> byLength;       // by word length: the ends filed at words that long
+   size_t entries;
+
+   int head(uint32_t word, ChainEnd end) const;
+
+	/**
+		The WordTrie length buckets around a word of length n that hold
+		at least one filed end.
+	*/
+   unsigned liveLengths(size_t n) const {
+      unsigned live = 0;
+      if (n > 0 && n - 1 < byLength.size() && byLength[n - 1] != 0) { live |= WordTrie::SHORTER; }
+      if (n < byLength.size() && byLength[n] != 0) { live |= WordTrie::SAME_LENGTH; }
+      if (n + 1 < byLength.size() && byLength[n + 1] != 0) { live |= WordTrie::LONGER; }
+      return live;
+   }
+
+ public:
+   EndpointIndex() : entries(0) { }
+
+   void insert(string_view word, uint32_t id, int chain, ChainEnd end);
+   void erase(string_view word, int chain, ChainEnd end);
+   Endpoint first(string_view word, Metric metric, bool stepGrowth = false) const;
+   size_t bytes() const;
+
+	/**
+		Offer the chain ends at distance one from word to accept in order,
+		lowest chain first and front before rear, until accept returns
+		true; that end is stored in found. Ends past the accepted one are
+		never read, so a common word's long list costs nothing once an
+		early chain is taken. accept must not change the index. Returns
+		false if no end was accepted.
+	*/
+   template <typename Accept>
+   bool firstAccepted(string_view word, Metric metric, Accept accept, Endpoint& found) const {
+      thread_local vector<uint32_t> near;
+      thread_local vector<uint32_t> lists;  // 2 * word id + end
+      thread_local vector<size_t> cursor;
+      near.clear();
+      unsigned live = liveLengths(word.size());
+      if (live != 0) { words.neighbors(word, metric, near, live); }
+
+      lists.clear();
+      for (size_t k = 0; k < near.size(); k++) { // keep the lists that have chains
+         for (uint32_t list = 2 * near[k]; list <= 2 * near[k] + 1; list++) {
+            if (list < ends.size() && !ends[list].empty()) { lists.push_back(list); }
+         }
+      }
+      cursor.assign(lists.size(), 0);
+
+      while (true) { // merge the ascending lists by 2 * chain + end, smallest first
+         size_t best = lists.size();
+         uint32_t bestSlot = 0;
+         for (size_t k = 0; k < lists.size(); k++) {
+            if (cursor[k] == ends[lists[k]].size()) { continue; }
+            uint32_t slot = 2 * (uint32_t)ends[lists[k]][cursor[k]] + (lists[k] & 1);
+            if (best == lists.size() || slot < bestSlot) { best = k; bestSlot = slot; }
+         }
+         if (best == lists.size()) { return false; }
+
+         cursor[best]++;
+         Endpoint e = { (int)(bestSlot / 2), ChainEnd(bestSlot & 1) };
+         if (accept(e)) {
+            found = e;
+            return true;
+         }
+      }
+   }
+};
+
+#endif
@@ -0,0 +1,146 @@
+/** 	
+	@name FilePipeline.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Reads many files at once through a pipeline of I/O threads.
+ */
+
+#include "FilePipeline.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static const size_t BATCH_WORDS = 1 << 16;
+
+/**
+	Start ioThreads readers (never more than there are files). Each
+	queue holds at most queueDepth batches, which bounds the memory the
+	readers can run ahead by.
+ */
+FilePipeline::FilePipeline(const vector<string>& paths, int filterLength, int ioThreads, size_t queueDepth)
+ : paths(paths), filterLength(filterLength), files(paths.size()), started(chrono::steady_clock::now()),
+   elapsed(0), file(0), batch(NULL), word(0)
+{
+   size_t readerCount = max<size_t>(1, min<size_t>(ioThreads, paths.size()));
+   for (size_t r = 0; r < readerCount; r++) { queues.push_back(new SpscQueue<WordBatch>(queueDepth)); }
+   for (size_t r = 0; r < readerCount && !paths.empty(); r++) {
+      readers.push_back(thread(&FilePipeline::read, this, r));
+   }
+}
+
+FilePipeline::~FilePipeline() {
+   string_view rest;
+   while (next(rest)) { } // drain so every reader can finish
+   for (size_t r = 0; r < queues.size(); r++) { delete queues[r]; }
+}
+
+/**
+	Reader thread: tokenize files reader, reader + readers, ... in turn
+	and queue their words in batches.
+ */
+void FilePipeline::read(size_t reader) {
+   SpscQueue<WordBatch>& queue = *queues[reader];
+   for (size_t f = reader; f < paths.size(); f += queues.size()) {
+      FileThroughput& stats = files[f];
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      double waited = 0;
+      stats.path = paths[f];
+      stats.words = 0;
+
+      MappedFile input;
+      stats.opened = input.open(paths[f]);
+      stats.bytes = input.size();
+
+      Tokenizer tokens(input.data(), input.size(), filterLength);
+      WordBatch* current = new WordBatch();
+      string_view w;
+      while (tokens.next(w)) {
+         current->text.insert(current->text.end(), w.begin(), w.end());
+         current->ends.push_back(current->text.size());
+         if (current->ends.size() == BATCH_WORDS) {
+            stats.words += current->ends.size();
+            current->last = false;
+            chrono::steady_clock::time_point wait = chrono::steady_clock::now();
+            queue.push(current);
+            waited += chrono::duration<double>(chrono::steady_clock::now() - wait).count();
+            current = new WordBatch();
+         }
+      }
+      stats.words += current->ends.size();
+      stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() - waited;
+      current->last = true;
+      queue.push(current);
+   }
+}
+
+/**
+	Hand out the next word, in file order. The view stays valid until
+	the next call. Returns false once every file has been read.
+ */
+bool FilePipeline::next(string_view& out) {
+   while (true) {
+      if (batch != NULL && word < batch->ends.size()) {
+         uint32_t begin = (word == 0) ? 0 : batch->ends[word - 1];
+         out = string_view(batch->text.data() + begin, batch->ends[word] - begin);
+         word++;
+         return true;
+      }
+      if (batch != NULL && batch->last) { file++; }
+      delete batch;
+      batch = NULL;
+      if (file >= paths.size()) {
+         finish();
+         return false;
+      }
+      batch = queues[file % queues.size()]->pop();
+      word = 0;
+   }
+}
+
+/**
+	Join the readers once the last file has been consumed.
+ */
+void FilePipeline::finish() {
+   if (readers.empty()) { return; }
+   for (size_t r = 0; r < readers.size(); r++) { readers[r].join(); }
+   readers.clear();
+   elapsed = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+}
+
+/**
+	Split a separated list, dropping empty entries.
+ */
+vector<string> splitList(const string& list, char separator) {
+   vector<string> parts;
+   size_t start = 0;
+   while (start <= list.size()) {
+      size_t end = list.find(separator, start);
+      if (end == string::npos) { end = list.size(); }
+      if (end > start) { parts.push_back(list.substr(start, end - start)); }
+      start = end + 1;
+   }
+   return parts;
+}
+
+/**
+	Append the regular files directly inside path to files, sorted by
+	name. Returns false if the directory cannot be read.
+ */
+bool listDirectory(const string& path, vector<string>& files) {
+   DIR* dir = opendir(path.c_str());
+   if (dir == NULL) { return false; }
+
+   vector<string> found;
+   while (struct dirent* entry = readdir(dir)) {
+      string name = path + "/" + entry->d_name;
+      struct stat st;
+      if (stat(name.c_str(), &st) == 0 && S_ISREG(st.st_mode)) { found.push_back(name); }
+   }
+   closedir(dir);
+
+   sort(found.begin(), found.end());
+   files.insert(files.end(), found.begin(), found.end());
+   return true;
+}
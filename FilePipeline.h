@@ -0,0 +1,159 @@
+/** 	
+	@name FilePipeline.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Reads many files at once. I/O threads map and tokenize files and
+	pass batches of words through bounded queues to a single
+	consumer, so reading the next files overlaps with building chains
+	from the current one. Words reach the consumer in file order, so the
+	chains are the same as for one file holding every input in turn.
+ */
+
+#ifndef FILEPIPELINE_H_
+#define FILEPIPELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include "Profile.h"
+
+using namespace std;
+
+/**
+	Single-producer, single-consumer ring of pointers. push() waits
+	while the ring is full and pop() while it is empty: a few yields
+	first, since the other side is usually about to move, then asleep on
+	a condition variable, so a reader stalled behind a slow consumer (or
+	the consumer behind slow disks) stops burning a core. Neither side
+	takes the lock unless the other is asleep.
+ */
+template <typename T>
+class SpscQueue {
+   static const int SPINS = 64;      // yields before going to sleep
+
+   vector<T*> slots;                 // size is a power of two
+   atomic<size_t> head;              // next slot to pop; written by the consumer only
+   atomic<size_t> tail;              // next slot to push; written by the producer only
+   atomic<bool> sleeping;            // one side waits on wakeup; both cannot, as the ring is never full and empty
+   mutex sleepLock;
+   condition_variable wakeup;
+
+   SpscQueue(const SpscQueue&);
+   SpscQueue& operator=(const SpscQueue&);
+
+	/**
+		Return once ready() holds. The fences pair with the one in wake():
+		either the waiter sees the other side's move, or the other side
+		sees sleeping and notifies under the lock the waiter holds until
+		it is waiting.
+	*/
+   template <typename Ready>
+   void waitFor(Ready ready) {
+      for (int spin = 0; spin < SPINS; spin++) {
+         if (ready()) { return; }
+         this_thread::yield();
+      }
+      unique_lock<mutex> lock(sleepLock);
+      sleeping.store(true, memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst);
+      while (!ready()) { wakeup.wait(lock); }
+      sleeping.store(false, memory_order_relaxed);
+   }
+
+   void wake() {
+      atomic_thread_fence(memory_order_seq_cst);
+      if (sleeping.load(memory_order_relaxed)) {
+         lock_guard<mutex> lock(sleepLock);
+         wakeup.notify_one();
+      }
+   }
+
+ public:
+   explicit SpscQueue(size_t capacity) : head(0), tail(0), sleeping(false) {
+      size_t c = 1;
+      while (c < capacity) { c *= 2; }
+      slots.resize(c, NULL);
+   }
+
+   void push(T* item) {
+      size_t t = tail.load(memory_order_relaxed);
+      if (t - head.load(memory_order_acquire) == slots.size()) {
+         profileCount(QUEUE_FULL_WAITS);
+         waitFor([&]() { return t - head.load(memory_order_acquire) != slots.size(); });
+      }
+      slots[t & (slots.size() - 1)] = item;
+      tail.store(t + 1, memory_order_release);
+      wake();
+   }
+
+   T* pop() {
+      size_t h = head.load(memory_order_relaxed);
+      if (tail.load(memory_order_acquire) == h) {
+         waitFor([&]() { return tail.load(memory_order_acquire) != h; });
+      }
+      T* item = slots[h & (slots.size() - 1)];
+      head.store(h + 1, memory_order_release);
+      wake();
+      return item;
+   }
+};
+
+template <typename T> const int SpscQueue<T>::SPINS;
+
+/**
+	Words read from one file, one batch of it at a time.
+ */
+struct WordBatch {
+   vector<char> text;          // the words back to back
+   vector<uint32_t> ends;      // end of each word in text
+   bool last;                  // no more batches for this file
+};
+
+struct FileThroughput {
+   string path;
+   bool opened;
+   uint64_t bytes;
+   uint64_t words;
+   double seconds;             // mapping and tokenizing, not waiting on the queue
+};
+
+class FilePipeline {
+   vector<string> paths;
+   size_t filterLength;
+   vector<SpscQueue<WordBatch>* > queues;   // file f travels through queues[f % queues.size()]
+   vector<thread> readers;
+   vector<FileThroughput> files;
+   chrono::steady_clock::time_point started;
+   double elapsed;
+
+   size_t file;           // file being consumed
+   WordBatch* batch;      // batch being consumed
+   size_t word;           // next word of batch
+
+   FilePipeline(const FilePipeline&);
+   FilePipeline& operator=(const FilePipeline&);
+
+   void read(size_t reader);
+   void finish();
+
+ public:
+   FilePipeline(const vector<string>& paths, int filterLength, int ioThreads, size_t queueDepth = 8);
+   ~FilePipeline();
+
+   bool next(string_view& word);
+
+   const vector<FileThroughput>& throughput() const { return files; }
+   double seconds() const { return elapsed; }
+};
+
+vector<string> splitList(const string& list, char separator);
+bool listDirectory(const string& path, vector<string>& files);
+
+#endif
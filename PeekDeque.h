@@ -1,243 +1,300 @@
-/** 	
-	@name PeekDeque.h
-	@author Robert Shannon
-	@email rshannon@buffalo.edu
-	
-	Double ended queue implementation using a vector.
- */
-
-#include <iostream>
-#include <string>
-#include <vector>
-#include <fstream>
-#include <sstream>
-#include "StringWrap.cpp"
-
-using std::vector;
-using std::endl;
-using std::cerr;
-using std::ostringstream;
-using std::string;
-using std::cout;
-
-
-template <typename T>
-class PeekDeque; 
-
-template <typename T>
-class Deque {
-   protected:
-    vector<T>* elements;
-    int rearSpace;
-    int frontItem;
-    int upperBound;
-
-   //CLASS INV: frontSpace indicates first empty cell for pushFront
-   //           rearItem designates rear item (not space) for popRear---
-   //           ---or if there is no such item, rearItem == frontSpace;
-
- public: 
-
-   explicit Deque(int guaranteedCapacity) 
-    : elements(new vector<T>(2*guaranteedCapacity)),
-      frontItem(guaranteedCapacity),
-      rearSpace(guaranteedCapacity),
-      upperBound(2*guaranteedCapacity) 
-   { }
-
-   virtual ~Deque() { delete elements; cout << "It's Deque Season!" << endl; }
-
-	/**
-		Determines whether PeekDeque is empty.
-	*/
-   virtual bool empty() const { return frontItem == rearSpace; }
-
-	/**
-		Determines whether PeekDeque is full.
-	*/
-   virtual bool full() const { return rearSpace == upperBound; }
-
-	/**
-		Determines total size of PeekDeque.
-	*/
-   virtual size_t size() const { return rearSpace - frontItem; }
-
-	/**
-		Add a item to the front of the PeekDeque.
-	*/
-   virtual void pushFront(T newItem) {
-      if (full()) {
-         cerr << "Are you playing with a full Deque?" << endl;
-         cerr << toString() << endl;
-      } else {
-         elements->at(--frontItem) = newItem;
-      }
-   }
-
-	/**
-		Add a item to the rear of the PeekDeque.
-	*/
-   virtual void pushRear(T newItem) {
-      if (full()) {
-         cerr << "Are you playing with a full Deque?" << endl;
-         cerr << toString() << endl;
-      } else {
-         elements->at(rearSpace++) = newItem;
-      }
-   }
-
-	/**
-		Delete and then return the item stored at the front of the PeekDeque.
-	*/
-   virtual T popFront() {
-      if (empty()) {
-         cerr << "Too lazy to throw an EmptyDequeException." << endl;
-         return T();
-      } else {
-         return elements->at(frontItem++);
-      }
-   }
-
-	/**
-		Delete and then return the item stored at the rear of the PeekDeque.
-	*/
-   virtual T popRear() {
-      if (empty()) {
-         cerr << "Too lazy to throw an EmptyDequeException." << endl;
-         return T();
-      } else {
-         return elements->at(--rearSpace);  //translates Java "next()"
-      }
-   }
-
-	/**
-		Returns each item in the PeekDeque, separated by a space.
-	*/
-   virtual string toString() const { 
-      ostringstream OUT;
-      //string out = "";
-      for (int i = frontItem; i < rearSpace; i++) {
-         //out += elements->at(i).str() + " ";
-         OUT << elements->at(i).str() << " ";
-      }
-      //return out;
-      return OUT.str();
-   }
-
-};
-
-
-template <class T>
-class PeekDeque : public Deque<T> {
-
-   int peekIndex;
-
- public:
-
-   explicit PeekDeque<T>(int guaranteedCapacity)
-    : Deque<T>(guaranteedCapacity), peekIndex(this->frontItem) { }
-
-   virtual ~PeekDeque() { cerr << "No peeking..."; } //automatically calls ~Deque()
-
-	/**
-		Modify peekIndex to move one step closer to the
-		front of the PeekDeque.  Move peekIndex back to 
-		rear if necessary.
-	*/
-   virtual void moveFrontward() { 
-		if(peekIndex == this->frontItem){
-			peekIndex = this->rearSpace;
-		}
-		else{
-			peekIndex--;
-		} 
-   }
-
-	/**
-		Modify peekIndex to move one step closer to the
-		rear of the PeekDeque. Move peekIndex back to
-		front if necessary.
-	*/
-   virtual void moveRearward() {
-		if(peekIndex == this->rearSpace){
-			peekIndex = this->frontItem;
-		}
-		else{
-			peekIndex++;
-		}
-   }
-
-	/**
-		Returns item stored at index stored in peekIndex
-	*/
-   virtual T peek() const { return this->elements->at(peekIndex); }
-
-	/**
-		Overrides parent class popFront() function changing
-		the message returned when popping from an empty
-		Deque.
-	*/
-   virtual T popFront() { 
-      if (this->empty()) { cerr << "Pop attempt from empty PeekDeque" << endl; }
-      else return Deque<T>::popFront();
-   }
-
-	/**
-		Overrides parent class popRear() function changing
-		the message returned when popping from an empty
-		Deque.
-	*/
-   virtual T popRear() {
-      if (this->empty()) { cerr << "Pop attempt from empty PeekDeque" << endl; }
-      else return Deque<T>::popRear();
-   }
-
-   //Extra functionality
-
-	/**
-		Reset peekIndex to front position.
-	*/
-    virtual void setPeekToFront() { peekIndex = this->frontItem; }
-
-	/**
-		Reset peekIndex to rear position.
-	*/
-    virtual bool setPeekToRear() const { return peekIndex == this->rearSpace; }
-	
-	/**
-		Return front item
-	*/
-    virtual T returnFront() const { return this->elements->at(this->frontItem); }
-	
-	/**
-		Return front item's neighbor (second to front)
-	*/
-    virtual T returnFrontNeighbor() const { return this->elements->at(this->frontItem+1); }
-	
-	
-	/**
-		Return rear item
-	*/
-	virtual T returnRear() const { return this->elements->at(this->rearSpace); }
-	
-	/**
-		Return rear item's neighbor (second to rear)
-	*/
-	virtual T returnRearNeighbor() const { return this->elements->at(this->rearSpace-1); }
-	
-	/**
-		Return front item variable
-	*/
-    virtual int returnFrontItem() const { return this->frontItem; }
-	
-	/**
-		Return rear space variable
-	*/
-	virtual int returnRearSpace() const { return this->rearSpace; }
-	
-	/**
-		Return item at specified index
-	*/
-	virtual int setPeekIndex(int index) { this->peekIndex = index; }
-
-};
+/**
+	@name PeekDeque.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+
+	Double ended queue implementation using a growable ring buffer.
+ */
+
+#ifndef PEEKDEQUE_H_
+#define PEEKDEQUE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <type_traits>
+#include "Arena.h"
+#include "Profile.h"
+
+using std::vector;
+using std::endl;
+using std::cerr;
+using std::ostringstream;
+using std::string;
+using std::cout;
+
+
+template <typename T, int INLINE = 4>
+class PeekDeque;
+
+template <typename T, int INLINE = 4>
+class Deque {
+   protected:
+    T* elements;      // either inline or a heap block of capacity slots
+    int capacity;     // always a power of two
+    int frontItem;    // slot of the front item
+    int count;
+    T inline_[INLINE];
+    MonotonicArena* arena;   // where grown storage comes from; NULL for new[]/delete[]
+
+   //CLASS INV: item i (0 = front) lives in elements[(frontItem + i) & (capacity - 1)];
+   //           elements == inline_ until the deque first outgrows INLINE items.
+
+	/**
+		Slot holding item i, counting from the front.
+	*/
+   int slot(int i) const { return (frontItem + i) & (capacity - 1); }
+
+	/**
+		Double the capacity, unrolling the ring so the front item is
+		back in slot 0.
+	*/
+   void grow() { profileCount(DEQUE_GROWS); reserve(2 * capacity); }
+
+   void reserve(int newCapacity) {
+      if (newCapacity <= capacity) { return; }
+      T* bigger;
+      if (arena) {
+         bigger = static_cast<T*>(arena->allocate(newCapacity * sizeof(T), alignof(T)));
+         for (int i = 0; i < newCapacity; i++) { new (bigger + i) T(); }
+      } else {
+         bigger = new T[newCapacity];
+      }
+      for (int i = 0; i < count; i++) {
+         bigger[i] = elements[slot(i)];
+      }
+      if (elements != inline_ && !arena) { delete[] elements; } // arena blocks are released with the arena
+      elements = bigger;
+      capacity = newCapacity;
+      frontItem = 0;
+   }
+
+ public:
+
+   explicit Deque(int guaranteedCapacity = 0)
+    : elements(inline_), capacity(INLINE), frontItem(0), count(0), arena(NULL)
+   {
+      int c = INLINE;
+      while (c < guaranteedCapacity) { c *= 2; }
+      reserve(c);
+   }
+
+   virtual ~Deque() { if (elements != inline_ && !arena) { delete[] elements; } }
+
+	/**
+		Take storage from arena from now on instead of the heap. Only for
+		items that need no destructor, and only while the deque still
+		fits in its inline slots.
+	*/
+   void useArena(MonotonicArena* from) {
+      static_assert(std::is_trivially_destructible<T>::value, "arena storage is never destroyed");
+      if (elements == inline_) { arena = from; }
+   }
+
+	/**
+		Grow from to in future, after the arena this deque used has been
+		adopted by to. Deques not using an arena are unaffected.
+	*/
+   void arenaAdopted(MonotonicArena* to) {
+      if (arena) { arena = to; }
+   }
+
+	/**
+		Determines whether PeekDeque is empty.
+	*/
+   bool empty() const { return count == 0; }
+
+	/**
+		Determines total size of PeekDeque.
+	*/
+   size_t size() const { return count; }
+
+	/**
+		Add a item to the front of the PeekDeque.
+	*/
+   void pushFront(const T& newItem) {
+      if (count == capacity) { grow(); }
+      frontItem = (frontItem - 1) & (capacity - 1);
+      elements[frontItem] = newItem;
+      count++;
+   }
+
+	/**
+		Add a item to the rear of the PeekDeque.
+	*/
+   void pushRear(const T& newItem) {
+      if (count == capacity) { grow(); }
+      elements[slot(count)] = newItem;
+      count++;
+   }
+
+	/**
+		Delete and then return the item stored at the front of the PeekDeque.
+	*/
+   T popFront() {
+      if (empty()) {
+         cerr << "Too lazy to throw an EmptyDequeException." << endl;
+         return T();
+      } else {
+         T item = elements[frontItem];
+         frontItem = slot(1);
+         count--;
+         return item;
+      }
+   }
+
+	/**
+		Delete and then return the item stored at the rear of the PeekDeque.
+	*/
+   T popRear() {
+      if (empty()) {
+         cerr << "Too lazy to throw an EmptyDequeException." << endl;
+         return T();
+      } else {
+         count--;
+         return elements[slot(count)];
+      }
+   }
+
+	/**
+		Return item i, counting from the front. No bounds check.
+	*/
+   const T& item(int i) const { return elements[slot(i)]; }
+
+	/**
+		Returns each item in the PeekDeque, separated by a space.
+	*/
+   string toString() const {
+      ostringstream OUT;
+      for (int i = 0; i < count; i++) {
+         OUT << item(i) << " ";
+      }
+      return OUT.str();
+   }
+
+ private:
+   Deque(const Deque&);
+   Deque& operator=(const Deque&);
+
+};
+
+
+template <class T, int INLINE>
+class PeekDeque : public Deque<T, INLINE> {
+
+   int peekIndex;   // counted from the front, so 0 is the front item and size() the rear space
+
+ public:
+
+   explicit PeekDeque(int guaranteedCapacity = 0)
+    : Deque<T, INLINE>(guaranteedCapacity), peekIndex(0) { }
+
+   virtual ~PeekDeque() { } //automatically calls ~Deque()
+
+	/**
+		Modify peekIndex to move one step closer to the
+		front of the PeekDeque.  Move peekIndex back to
+		rear if necessary.
+	*/
+   void moveFrontward() {
+		if(peekIndex == 0){
+			peekIndex = this->count;
+		}
+		else{
+			peekIndex--;
+		}
+   }
+
+	/**
+		Modify peekIndex to move one step closer to the
+		rear of the PeekDeque. Move peekIndex back to
+		front if necessary.
+	*/
+   void moveRearward() {
+		if(peekIndex == this->count){
+			peekIndex = 0;
+		}
+		else{
+			peekIndex++;
+		}
+   }
+
+	/**
+		Returns item stored at index stored in peekIndex
+	*/
+   const T& peek() const { return this->item(peekIndex); }
+
+	/**
+		Overrides parent class popFront() function changing
+		the message returned when popping from an empty
+		Deque.
+	*/
+   T popFront() {
+      if (this->empty()) { cerr << "Pop attempt from empty PeekDeque" << endl; return T(); }
+      else return Deque<T, INLINE>::popFront();
+   }
+
+	/**
+		Overrides parent class popRear() function changing
+		the message returned when popping from an empty
+		Deque.
+	*/
+   T popRear() {
+      if (this->empty()) { cerr << "Pop attempt from empty PeekDeque" << endl; return T(); }
+      else return Deque<T, INLINE>::popRear();
+   }
+
+   //Extra functionality
+
+	/**
+		Reset peekIndex to front position.
+	*/
+    void setPeekToFront() { peekIndex = 0; }
+
+	/**
+		Determines whether peekIndex is at the rear position.
+	*/
+    bool setPeekToRear() const { return peekIndex == this->count; }
+
+	/**
+		Return front item
+	*/
+    const T& returnFront() const { return this->item(0); }
+
+	/**
+		Return front item's neighbor (second to front)
+	*/
+    const T& returnFrontNeighbor() const { return this->item(1); }
+
+
+	/**
+		Return rear item
+	*/
+	const T& returnRear() const { return this->item(this->count - 1); }
+
+	/**
+		Return rear item's neighbor (second to rear)
+	*/
+	const T& returnRearNeighbor() const { return this->item(this->count - 2); }
+
+	/**
+		Return front item variable
+	*/
+    int returnFrontItem() const { return 0; }
+
+	/**
+		Return rear space variable
+	*/
+	int returnRearSpace() const { return this->count; }
+
+	/**
+		Return item at specified index
+	*/
+	void setPeekIndex(int index) { this->peekIndex = index; }
+
+};
+
+#endif
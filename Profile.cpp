@@ -0,0 +1,51 @@
+/** 	
+	@name Profile.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Counters and phase timers for --stats.
+ */
+
+#include "Profile.h"
+#include <atomic>
+
+static atomic<uint64_t> totals[COUNTER_COUNT];        // from threads that have finished
+static atomic<uint64_t> phaseTotals[PHASE_COUNT];
+
+/**
+	Fold a finished thread's counts into the totals.
+ */
+ProfileCounters::~ProfileCounters() {
+   for (int c = 0; c < COUNTER_COUNT; c++) { totals[c].fetch_add(value[c], memory_order_relaxed); }
+}
+
+#ifndef WORDCHAIN_NO_PROFILE
+PhaseTimer::~PhaseTimer() {
+   uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+   phaseTotals[phase].fetch_add(ns, memory_order_relaxed);
+}
+#endif
+
+/**
+	Count so far: every finished thread plus the calling thread.
+ */
+uint64_t profileTotal(Counter counter) {
+   return totals[counter].load(memory_order_relaxed) + threadCounters.value[counter];
+}
+
+uint64_t phaseNanoseconds(Phase phase) {
+   return phaseTotals[phase].load(memory_order_relaxed);
+}
+
+const char* counterName(Counter counter) {
+   static const char* names[COUNTER_COUNT] = {
+      "words_read", "words_filtered", "neighbors", "candidates", "distance_tests",
+      "duplicate_checks", "chains_created", "chains_merged", "deque_grows", "queue_full_waits", "bytes_written"
+   };
+   return names[counter];
+}
+
+const char* phaseName(Phase phase) {
+   static const char* names[PHASE_COUNT] = { "load", "read", "build", "merge", "save", "report" };
+   return names[phase];
+}
@@ -0,0 +1,99 @@
+/** 	
+	@name Profile.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Counters and phase timers for --stats. Each thread counts into its
+	own block, which is added to the shared totals when the thread ends,
+	so the hot paths never touch shared memory. Building with
+	-DWORDCHAIN_NO_PROFILE (make PROFILE=0) turns every call below into
+	dead code that the compiler removes.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <chrono>
+#include <stdint.h>
+
+using namespace std;
+
+#ifdef WORDCHAIN_NO_PROFILE
+static const bool PROFILING = false;
+#else
+static const bool PROFILING = true;
+#endif
+
+enum Counter {
+   WORDS_READ,          // words the tokenizer handed out
+   WORDS_FILTERED,      // tokens dropped as non-alphabetic or too short
+   NEIGHBORS,           // vocabulary words at distance one found in the trie
+   CANDIDATES,          // chain ends at those words
+   DISTANCE_TESTS,      // words compared by EditPattern::screen, hd1 or xd1
+   DUPLICATE_CHECKS,
+   CHAINS_CREATED,
+   CHAINS_MERGED,       // joins made by --merge-chains
+   DEQUE_GROWS,         // a full deque moved to bigger storage
+   QUEUE_FULL_WAITS,    // a file reader found its queue full
+   BYTES_WRITTEN,
+   COUNTER_COUNT
+};
+
+enum Phase {
+   PHASE_LOAD,          // --load-state
+   PHASE_READ,          // parallel tokenizing, when separate from building
+   PHASE_BUILD,         // building chains, including tokenizing when done in the same pass
+   PHASE_MERGE,         // --merge-chains
+   PHASE_SAVE,          // --save-state
+   PHASE_REPORT,
+   PHASE_COUNT
+};
+
+struct ProfileCounters {
+   uint64_t value[COUNTER_COUNT];
+
+   ProfileCounters() { for (int c = 0; c < COUNTER_COUNT; c++) { value[c] = 0; } }
+   ~ProfileCounters();
+};
+
+// this thread's counts; inline so a count is a thread-local add with no call
+inline thread_local ProfileCounters threadCounters;
+
+/**
+	Add n to counter for this thread.
+ */
+inline void profileCount(Counter counter, uint64_t n = 1) {
+#ifndef WORDCHAIN_NO_PROFILE
+   threadCounters.value[counter] += n;
+#else
+   (void)counter;
+   (void)n;
+#endif
+}
+
+/**
+	Adds the time between its construction and destruction to a phase.
+ */
+class PhaseTimer {
+   Phase phase;
+   chrono::steady_clock::time_point start;
+
+   PhaseTimer(const PhaseTimer&);
+   PhaseTimer& operator=(const PhaseTimer&);
+
+ public:
+#ifndef WORDCHAIN_NO_PROFILE
+   explicit PhaseTimer(Phase phase) : phase(phase), start(chrono::steady_clock::now()) {}
+   ~PhaseTimer();
+#else
+   explicit PhaseTimer(Phase phase) : phase(phase) {}
+   ~PhaseTimer() {}
+#endif
+};
+
+uint64_t profileTotal(Counter counter);
+uint64_t phaseNanoseconds(Phase phase);
+const char* counterName(Counter counter);
+const char* phaseName(Phase phase);
+
+#endif
@@ -0,0 +1,82 @@
+/** 	
+	@name ReportWriter.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Buffered output for reports.
+ */
+
+#include "ReportWriter.h"
+#include "Profile.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+ReportWriter::ReportWriter(int fd, size_t capacity)
+ : fd(fd), buffer(capacity), used(0), written(0) { }
+
+/**
+	Append size bytes, flushing first if they do not fit. Anything larger
+	than the whole buffer goes straight to the file.
+ */
+void ReportWriter::write(const void* data, size_t size) {
+   if (used + size > buffer.size()) {
+      flush();
+      if (size > buffer.size()) {
+         const char* p = static_cast<const char*>(data);
+         while (size > 0) {
+            ssize_t n = ::write(fd, p, size);
+            if (n < 0 && errno == EINTR) { continue; }
+            if (n <= 0) { return; }
+            p += n;
+            size -= n;
+            written += n;
+            profileCount(BYTES_WRITTEN, n);
+         }
+         return;
+      }
+   }
+   memcpy(&buffer[used], data, size);
+   used += size;
+}
+
+/**
+	Hand everything buffered to the file.
+ */
+void ReportWriter::flush() {
+   size_t done = 0;
+   while (done < used) {
+      ssize_t n = ::write(fd, &buffer[done], used - done);
+      if (n < 0 && errno == EINTR) { continue; }
+      if (n <= 0) { break; }
+      done += n;
+   }
+   written += done;
+   profileCount(BYTES_WRITTEN, done);
+   used = 0;
+}
+
+/**
+	Format a decimal number without going through a stream.
+ */
+void ReportWriter::writeNumber(uint64_t n, bool negative) {
+   char digits[21];
+   int k = sizeof(digits);
+   do {
+      digits[--k] = '0' + n % 10;
+      n /= 10;
+   } while (n > 0);
+   if (negative) { digits[--k] = '-'; }
+   write(digits + k, sizeof(digits) - k);
+}
+
+/**
+	Format a measurement with three decimal places.
+ */
+ReportWriter& ReportWriter::operator<<(double n) {
+   char digits[32];
+   int length = snprintf(digits, sizeof(digits), "%.3f", n);
+   write(digits, length);
+   return *this;
+}
@@ -0,0 +1,70 @@
+/** 	
+	@name ReportWriter.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Buffered output for reports. Text is formatted straight into one
+	large reusable buffer that is handed to write(2) only when it fills
+	up, so even a report of millions of chains takes few system calls.
+ */
+
+#ifndef REPORTWRITER_H_
+#define REPORTWRITER_H_
+
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+enum OutputFormat { TEXT, NDJSON, BINARY };
+
+class ReportWriter {
+   int fd;
+   vector<char> buffer;
+   size_t used;
+   uint64_t written;
+
+   ReportWriter(const ReportWriter&);
+   ReportWriter& operator=(const ReportWriter&);
+
+   void writeNumber(uint64_t n, bool negative);
+
+ public:
+   explicit ReportWriter(int fd, size_t capacity = 1 << 20);
+   ~ReportWriter() { flush(); }
+
+   void write(const void* data, size_t size);
+   void flush();
+   uint64_t bytesWritten() const { return written + used; }
+
+   ReportWriter& operator<<(string_view text) { write(text.data(), text.size()); return *this; }
+   ReportWriter& operator<<(const char* text) { return *this << string_view(text); }
+   ReportWriter& operator<<(char c) { write(&c, 1); return *this; }
+   ReportWriter& operator<<(double n);
+
+   template <typename N>
+   typename enable_if<is_integral<N>::value, ReportWriter&>::type operator<<(N n) {
+      if (n < 0) { writeNumber(0 - (uint64_t)n, true); } else { writeNumber(n, false); }
+      return *this;
+   }
+
+	/**
+		Write n as four little-endian bytes, for the binary format.
+	*/
+   void writeUint32(uint32_t n) {
+      unsigned char bytes[4] = { (unsigned char)n, (unsigned char)(n >> 8), (unsigned char)(n >> 16), (unsigned char)(n >> 24) };
+      write(bytes, 4);
+   }
+
+	/**
+		Write n as eight little-endian bytes.
+	*/
+   void writeUint64(uint64_t n) {
+      writeUint32(n);
+      writeUint32(n >> 32);
+   }
+};
+
+#endif
@@ -0,0 +1,299 @@
+/** 	
+	@name Snapshot.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Saving and restoring built chains.
+ */
+
+#include "Snapshot.h"
+#include "ReportWriter.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = { 'W', 'C', 'G', 'S', 'N', 'A', 'P', '\0' };
+static const uint32_t VERSION = 1;
+
+/**
+	Fixed header at the start of a snapshot. The arrays follow in this
+	order, each padded to a multiple of 8 bytes: chars, offsets, hashes,
+	table, chain starts (uint64, chains + 1) and chain words (uint32).
+	Integers are in host byte order.
+ */
+struct SnapshotHeader {
+   char magic[8];
+   uint32_t version;
+   uint32_t flags;        // 1 = duplicates allowed, 2 = step growth, bits 2-3 the Metric
+   uint64_t wordCount;
+   uint64_t words;        // unique words in the pool
+   uint64_t charBytes;
+   uint64_t tableSize;
+   uint64_t chains;
+   uint64_t chainWords;
+   uint64_t checksum;     // of everything after the header
+};
+
+static size_t padded(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+
+/**
+	Checksum of a run of 8-byte words, continuing from h.
+ */
+static uint64_t checksum(uint64_t h, const char* data, size_t bytes) {
+   for (size_t k = 0; k + 8 <= bytes; k += 8) {
+      uint64_t w;
+      memcpy(&w, data + k, 8);
+      h = (h ^ w) * 0x100000001b3ull;
+      h ^= h >> 29;
+   }
+   return h;
+}
+
+/**
+	Fail a load: set error to say why path cannot be used.
+ */
+static bool reject(const string& path, const char* why, string& error) {
+   error = path + " " + why;
+   return false;
+}
+
+/**
+	Check that the arrays of a snapshot whose checksum matched describe a
+	pool and chains that are safe to use: known option flags, word
+	offsets that increase and end at the arena's end, each word's stored
+	hash matching its text, a hash table whose size is a power of two
+	holding every id once with a slot to spare (so a probe always stops),
+	each id where a lookup of its text stops (so no word can be found
+	under two ids or missed and interned again), chains that are not
+	empty and cover the id array exactly, and every id naming a word.
+ */
+static const char* checkArrays(const SnapshotHeader& header, const char* chars, const uint32_t* offsets,
+                               const uint32_t* hashes, const uint32_t* table, const uint64_t* starts, const uint32_t* ids) {
+   if ((header.flags >> 4) != 0 || ((header.flags >> 2) & 3) == 3) { return "is corrupt (unknown option flags)"; }
+   if (header.words >= WordPool::NOT_FOUND) { return "is corrupt (too many words)"; }
+   if (offsets[0] != 0 || offsets[header.words] != header.charBytes) { return "is corrupt (bad word offsets)"; }
+   for (uint64_t k = 0; k < header.words; k++) {
+      if (offsets[k] >= offsets[k + 1]) { return "is corrupt (bad word offsets)"; }
+   }
+   if (header.tableSize <= header.words || (header.tableSize & (header.tableSize - 1)) != 0) { return "is corrupt (bad hash table size)"; }
+   vector<bool> listed(header.words, false);
+   uint64_t occupied = 0;
+   for (uint64_t k = 0; k < header.tableSize; k++) {
+      if (table[k] == WordPool::NOT_FOUND) { continue; }
+      if (table[k] >= header.words || listed[table[k]]) { return "is corrupt (bad hash table)"; }
+      listed[table[k]] = true;
+      occupied++;
+   }
+   if (occupied != header.words) { return "is corrupt (bad hash table)"; }
+   uint32_t mask = header.tableSize - 1;
+   for (uint32_t id = 0; id < header.words; id++) { // probe for each word as WordPool::slotOf does
+      string_view word(chars + offsets[id], offsets[id + 1] - offsets[id] - 1);
+      if (hashes[id] != WordPool::hash(word)) { return "is corrupt (bad word hash)"; }
+      uint32_t k = hashes[id] & mask;
+      for (; table[k] != id; k = (k + 1) & mask) {
+         uint32_t other = table[k];
+         if (other == WordPool::NOT_FOUND) { return "is corrupt (word off its hash chain)"; }
+         if (hashes[other] == hashes[id] && string_view(chars + offsets[other], offsets[other + 1] - offsets[other] - 1) == word) {
+            return "is corrupt (word stored twice)";
+         }
+      }
+   }
+   if (starts[0] != 0 || starts[header.chains] != header.chainWords) { return "is corrupt (bad chain starts)"; }
+   for (uint64_t i = 0; i < header.chains; i++) {
+      if (starts[i] >= starts[i + 1]) { return "is corrupt (bad chain starts)"; }
+   }
+   for (uint64_t k = 0; k < header.chainWords; k++) {
+      if (ids[k] >= header.words) { return "is corrupt (bad word id)"; }
+   }
+   return NULL;
+}
+
+/**
+	Write one array followed by zero padding, folding it into the checksum.
+ */
+static void writeArray(ReportWriter& out, uint64_t& sum, const void* data, size_t bytes) {
+   const char* p = static_cast<const char*>(data);
+   size_t whole = bytes & ~(size_t)7;
+   out.write(p, whole);
+   sum = checksum(sum, p, whole);
+   if (whole != bytes) {
+      char last[8] = { 0 };
+      memcpy(last, p + whole, bytes - whole);
+      out.write(last, 8);
+      sum = checksum(sum, last, 8);
+   }
+}
+
+/**
+	Write the pool and chains to path. Returns false and sets error if
+	the file cannot be written.
+ */
+bool saveSnapshot(const string& path, const WordPool& pool, const vector<Chain* >& chains, const SnapshotInfo& info, string& error) {
+   int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if (fd < 0) { error = "cannot create " + path; return false; }
+
+   WordPoolArrays a = pool.arrays();
+   vector<uint64_t> starts(1, 0);
+   for (size_t i = 0; i < chains.size(); i++) { starts.push_back(starts.back() + chains[i]->size()); }
+
+   SnapshotHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.flags = (info.allowDuplicate ? 1 : 0) | (info.stepGrowth ? 2 : 0) | (info.metric << 2);
+   header.wordCount = info.wordCount;
+   header.words = a.words;
+   header.charBytes = a.charBytes;
+   header.tableSize = a.tableSize;
+   header.chains = chains.size();
+   header.chainWords = starts.back();
+
+   uint64_t sum = 0xcbf29ce484222325ull;
+   bool written;
+   {
+      ReportWriter out(fd);
+      out.write(&header, sizeof(header)); // the checksum is filled in below
+      writeArray(out, sum, a.chars, a.charBytes);
+      writeArray(out, sum, a.offsets, (a.words + 1) * sizeof(uint32_t));
+      writeArray(out, sum, a.hashes, a.words * sizeof(uint32_t));
+      writeArray(out, sum, a.table, a.tableSize * sizeof(uint32_t));
+      writeArray(out, sum, starts.data(), starts.size() * sizeof(uint64_t));
+
+      vector<uint32_t> ids;
+      for (size_t i = 0; i < chains.size(); i++) {
+         for (size_t k = 0; k < chains[i]->size(); k++) { ids.push_back(chains[i]->item(k)); }
+         if (ids.size() >= (1 << 16) || i + 1 == chains.size()) { // whole 8-byte words until the last batch
+            size_t flush = (i + 1 == chains.size()) ? ids.size() : ids.size() & ~(size_t)1;
+            writeArray(out, sum, ids.data(), flush * sizeof(uint32_t));
+            ids.erase(ids.begin(), ids.begin() + flush);
+         }
+      }
+      out.flush();
+      written = out.bytesWritten() == sizeof(header) + padded(a.charBytes) + padded((a.words + 1) * 4) + padded(a.words * 4)
+                                   + padded(a.tableSize * 4) + starts.size() * 8 + padded(starts.back() * 4);
+   }
+
+   header.checksum = sum;
+   written = written && pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+   written = (close(fd) == 0) && written;
+   if (!written) { error = "could not write all of " + path; }
+   return written;
+}
+
+/**
+	Read bytes at offset in fd into data, in as many reads as it takes.
+ */
+static bool readAt(int fd, uint64_t offset, void* data, size_t bytes) {
+   char* p = static_cast<char*>(data);
+   while (bytes > 0) {
+      ssize_t n = pread(fd, p, bytes, offset);
+      if (n < 0 && errno == EINTR) { continue; }
+      if (n <= 0) { return false; }
+      p += n;
+      offset += n;
+      bytes -= n;
+   }
+   return true;
+}
+
+/**
+	Closes a file descriptor when it goes out of scope.
+ */
+struct OpenFile {
+   int fd;
+   explicit OpenFile(int fd) : fd(fd) { }
+   ~OpenFile() { if (fd >= 0) { close(fd); } }
+};
+
+/**
+	Read path, check it and rebuild the pool, chains and statistics from
+	it. Each pool array is read straight into the buffer the pool then
+	adopts, so it is never copied again or re-hashed. The chains are
+	appended to chains, which should be empty, and are made in arena if
+	one is given.
+	Returns false and sets error if the snapshot is missing, from
+	another version, truncated or corrupt. Every count in the header is
+	bounded by the file size before it is used in a size, so no size can
+	overflow, and the arrays are checked before anything is built.
+ */
+bool loadSnapshot(const string& path, WordPool& pool, vector<Chain* >& chains, ChainStats& stats, SnapshotInfo& info, string& error, ChainArena* arena) {
+   OpenFile file(open(path.c_str(), O_RDONLY));
+   struct stat status;
+   if (file.fd < 0 || fstat(file.fd, &status) != 0) { error = "cannot open " + path; return false; }
+   uint64_t fileSize = status.st_size;
+
+   SnapshotHeader header;
+   if (fileSize < sizeof(header) || !readAt(file.fd, 0, &header, sizeof(header))) { return reject(path, "is not a snapshot", error); }
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) { return reject(path, "is not a snapshot", error); }
+   if (header.version != VERSION) { return reject(path, "was written by an incompatible version", error); }
+
+   // no array can have more entries than the file has bytes
+   if (header.charBytes > fileSize || header.words >= fileSize || header.tableSize > fileSize
+       || header.chains >= fileSize || header.chainWords > fileSize) {
+      return reject(path, "is truncated", error);
+   }
+   size_t sizes[6] = { padded(header.charBytes), padded((header.words + 1) * 4), padded(header.words * 4),
+                       padded(header.tableSize * 4), (header.chains + 1) * 8, padded(header.chainWords * 4) };
+   uint64_t total = sizeof(header);
+   for (int s = 0; s < 6; s++) {
+      if (sizes[s] > fileSize - total) { return reject(path, "is truncated", error); }
+      total += sizes[s];
+   }
+   if (total != fileSize) { return reject(path, "is truncated", error); }
+
+   vector<char> chars(sizes[0]);
+   vector<uint32_t> offsets(sizes[1] / 4);
+   vector<uint32_t> hashes(sizes[2] / 4);
+   vector<uint32_t> table(sizes[3] / 4);
+   vector<uint64_t> starts(sizes[4] / 8);
+   vector<uint32_t> ids(sizes[5] / 4);
+   void* into[6] = { chars.data(), offsets.data(), hashes.data(), table.data(), starts.data(), ids.data() };
+   uint64_t sum = 0xcbf29ce484222325ull;
+   uint64_t offset = sizeof(header);
+   for (int s = 0; s < 6; s++) { // the arrays are padded to 8 bytes, so summing them in turn sums the file
+      if (!readAt(file.fd, offset, into[s], sizes[s])) { return reject(path, "is truncated", error); }
+      sum = checksum(sum, static_cast<const char*>(into[s]), sizes[s]);
+      offset += sizes[s];
+   }
+   if (sum != header.checksum) { return reject(path, "is corrupt (checksum mismatch)", error); }
+   const char* invalid = checkArrays(header, chars.data(), offsets.data(), hashes.data(), table.data(), starts.data(), ids.data());
+   if (invalid != NULL) { return reject(path, invalid, error); }
+
+   chars.resize(header.charBytes); // drop the padding
+   offsets.resize(header.words + 1);
+   hashes.resize(header.words);
+   table.resize(header.tableSize);
+   pool.adopt(move(chars), move(offsets), move(hashes), move(table));
+
+   info.wordCount = header.wordCount;
+   info.allowDuplicate = header.flags & 1;
+   info.stepGrowth = header.flags & 2;
+   info.metric = (Metric)((header.flags >> 2) & 3);
+
+   for (size_t i = 0; i < header.chains; i++) {
+      Chain* chain = arena ? arena->create(&pool, !info.allowDuplicate) : new Chain(&pool, !info.allowDuplicate);
+      for (uint64_t k = starts[i]; k < starts[i + 1]; k++) {
+         chain->pushRear(ids[k]);
+         if (k == starts[i]) {
+            stats.newChain(i, ids[k], pool.length(ids[k]));
+         } else {
+            stats.grewChain(i, k - starts[i] + 1, ids[k], pool.length(ids[k]));
+         }
+      }
+      chains.push_back(chain);
+   }
+   return true;
+}
+
+/**
+	Enter both ends of every chain into index, as testNewWord would have
+	left them, so more words can be added to restored chains.
+ */
+void indexChains(const vector<Chain* >& chains, const WordPool& pool, EndpointIndex& index) {
+   for (size_t i = 0; i < chains.size(); i++) {
+      index.insert(pool.str(chains[i]->returnFront()), chains[i]->returnFront(), i, FRONT);
+      index.insert(pool.str(chains[i]->returnRear()), chains[i]->returnRear(), i, REAR);
+   }
+}
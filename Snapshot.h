@@ -0,0 +1,29 @@
+/** 	
+	@name Snapshot.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Saving and restoring built chains. A snapshot holds the word pool
+	(arena, offsets, hashes and hash table) and every chain as a run of
+	word ids, laid out as aligned raw arrays behind a fixed header. On
+	load each pool array is read straight into the buffer the pool takes
+	over: nothing is tokenized, re-hashed or copied a second time.
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "ChainBuilder.h"
+
+struct SnapshotInfo {
+   size_t wordCount;     // words read to build the chains
+   bool allowDuplicate;  // options the chains were built with
+   bool stepGrowth;
+   Metric metric;
+};
+
+bool saveSnapshot(const string& path, const WordPool& pool, const vector<Chain* >& chains, const SnapshotInfo& info, string& error);
+bool loadSnapshot(const string& path, WordPool& pool, vector<Chain* >& chains, ChainStats& stats, SnapshotInfo& info, string& error, ChainArena* arena = NULL);
+void indexChains(const vector<Chain* >& chains, const WordPool& pool, EndpointIndex& index);
+
+#endif
@@ -0,0 +1,183 @@
+/** 	
+	@name Tokenizer.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Zero-copy word reader over a memory-mapped file.
+ */
+
+#include "Tokenizer.h"
+#include "Profile.h"
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+	Map path into memory. Returns false if it cannot be opened.
+ */
+bool MappedFile::open(const string& path) {
+   close();
+
+   int fd = ::open(path.c_str(), O_RDONLY);
+   if (fd < 0) { return false; }
+
+   struct stat st;
+   if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return false;
+   }
+
+   length = st.st_size;
+   if (length > 0) {
+      void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+         ::close(fd);
+         length = 0;
+         return false;
+      }
+      madvise(p, length, MADV_SEQUENTIAL);
+      bytes = static_cast<const char*>(p);
+   }
+   ::close(fd); // the mapping stays valid
+   return true;
+}
+
+/**
+	Unmap the file, if one is mapped.
+ */
+void MappedFile::close() {
+   if (bytes) { munmap(const_cast<char*>(bytes), length); }
+   bytes = NULL;
+   length = 0;
+}
+
+static inline bool isSpace(char c) {
+   return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isLetter(char c) {
+   return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+}
+
+/**
+	A negative filterLength admits nothing, matching the old size_t
+	comparison in main.
+ */
+Tokenizer::Tokenizer(const char* data, size_t size, int filterLength)
+ : cursor(data), end(data + size), filterLength(filterLength), buffer(64) { }
+
+/**
+	Advance to the next word that survives trimming, the alpha check and
+	the length filter, and set word to its lowercase form. The view is
+	only valid until the next call. Returns false at end of input.
+ */
+bool Tokenizer::next(string_view& word) {
+   while (cursor < end) {
+      while (cursor < end && isSpace(*cursor)) { cursor++; }
+
+      const char* start = cursor;
+      size_t n = 0;          // letters copied so far
+      bool gap = false;      // a non-letter has followed the first letter
+      bool rejected = false; // a letter came after such a gap
+
+      for (; cursor < end && !isSpace(*cursor); cursor++) {
+         char c = *cursor;
+         if (isLetter(c)) {
+            if (gap) { rejected = true; break; }
+            if (n == buffer.size()) { buffer.resize(2 * n); }
+            buffer[n++] = c | 0x20; // lowercase
+         } else if (n > 0) {
+            gap = true;
+         }
+      }
+      while (cursor < end && !isSpace(*cursor)) { cursor++; } // rest of a rejected word
+
+      if (!rejected && n > 0 && n > filterLength) {
+         word = string_view(&buffer[0], n);
+         profileCount(WORDS_READ);
+         return true;
+      }
+      if (cursor > start) { profileCount(WORDS_FILTERED); }
+   }
+   return false;
+}
+
+StreamReader::StreamReader(int fd, int filterLength)
+ : fd(fd), block(1 << 20), filled(0), tail(0), eof(false), skipping(false), tokens(NULL, 0, filterLength) { }
+
+/**
+	Read more input and hand every complete word in it to the tokenizer.
+	The unfinished word at the end of the last block is moved to the
+	front first. Returns false once the input is exhausted.
+ */
+bool StreamReader::refill() {
+   if (eof) { return false; }
+
+   memmove(&block[0], &block[tail], filled - tail);
+   filled -= tail;
+   tail = 0;
+
+   for (;;) {
+      if (filled == block.size()) { // a single run fills the block, so drop it and skip the rest of it
+         filled = 0;
+         skipping = true;
+         profileCount(WORDS_FILTERED);
+      }
+      ssize_t got = read(fd, &block[filled], block.size() - filled);
+      if (got < 0 && errno == EINTR) { continue; }
+      if (got <= 0) { // end of input, so whatever is left is complete
+         eof = true;
+         tokens.reset(block.data(), filled);
+         tail = filled;
+         return true;
+      }
+
+      size_t start = filled;
+      filled += got;
+      if (skipping) { // only the bytes after the run's first whitespace are kept
+         size_t end = start;
+         while (end < filled && !isSpace(block[end])) { end++; }
+         memmove(&block[start], &block[end], filled - end);
+         filled = start + (filled - end);
+         skipping = (filled == start);
+      }
+      size_t cut = filled;
+      while (cut > start && !isSpace(block[cut - 1])) { cut--; }
+      if (cut > start) { // every word before the last whitespace is complete
+         tokens.reset(block.data(), cut);
+         tail = cut;
+         return true;
+      }
+   }
+}
+
+/**
+	Advance to the next word, reading more input as needed. The view is
+	only valid until the next call. Returns false at end of input.
+ */
+bool StreamReader::next(string_view& word) {
+   while (!tokens.next(word)) {
+      if (!refill()) { return false; }
+   }
+   return true;
+}
+
+/**
+	Cut data into parts pieces of roughly equal size, moving each cut
+	forward to the next whitespace so no word is split. Returns the
+	parts + 1 offsets of the piece boundaries (some pieces may be empty).
+ */
+vector<size_t> splitAtWhitespace(const char* data, size_t size, int parts) {
+   vector<size_t> cuts(1, 0);
+   for (int k = 1; k < parts; k++) {
+      size_t cut = max(cuts.back(), size / parts * k);
+      while (cut < size && !isSpace(data[cut])) { cut++; }
+      cuts.push_back(cut);
+   }
+   cuts.push_back(size);
+   return cuts;
+}
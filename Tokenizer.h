@@ -0,0 +1,84 @@
+/** 	
+	@name Tokenizer.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Zero-copy word reader over a memory-mapped file.
+ */
+
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+	Read-only memory mapping of a whole file.
+ */
+class MappedFile {
+   const char* bytes;
+   size_t length;
+
+   MappedFile(const MappedFile&);
+   MappedFile& operator=(const MappedFile&);
+
+ public:
+   MappedFile() : bytes(NULL), length(0) { }
+   ~MappedFile() { close(); }
+
+   bool open(const string& path);
+   void close();
+
+   const char* data() const { return bytes; }
+   size_t size() const { return length; }
+};
+
+/**
+	Splits a buffer into words the same way the StringWrap pipeline did
+	(whitespace-separated, trimNonAlpha, isAlpha, length filter, then
+	makeLower), but in a single pass and without allocating per word.
+ */
+class Tokenizer {
+   const char* cursor;
+   const char* end;
+   size_t filterLength;
+   vector<char> buffer;   // lowercased copy of the current word; grows only for record-length words
+
+ public:
+   Tokenizer(const char* data, size_t size, int filterLength);
+
+   void reset(const char* data, size_t size) { cursor = data; end = data + size; }
+   bool next(string_view& word);
+};
+
+/**
+	Reads words from a file descriptor (a pipe, a terminal or a file of
+	any length) in fixed-size blocks, tokenizing each block with a
+	Tokenizer. Only the partial word at the end of a block is carried
+	over, so memory use does not depend on the length of the input. A run
+	of input with no whitespace that fills a whole block is no word, and
+	is skipped to the next whitespace rather than read into memory.
+ */
+class StreamReader {
+   int fd;
+   vector<char> block;
+   size_t filled;     // bytes of block holding input
+   size_t tail;       // start of the bytes not yet handed to tokens
+   bool eof;
+   bool skipping;     // inside a run too long to be a word
+   Tokenizer tokens;
+
+   bool refill();
+
+ public:
+   StreamReader(int fd, int filterLength);
+
+   bool next(string_view& word);
+};
+
+vector<size_t> splitAtWhitespace(const char* data, size_t size, int parts);
+
+#endif
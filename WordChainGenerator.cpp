@@ -1,377 +1,1155 @@
-/** 	
-	@name WordChainGenerator.cpp
-	@author Robert Shannon
-	@email rshannon@buffalo.edu
-	
-	A word chain generator written in C++ for Dr. Regan's CSE 250
-	Course at University at Buffalo.
- */
-
-#include "PeekDeque.h"
-#include <stdlib.h>
-
-using namespace std;
-
-/** 
-	Strings lhs and rhs have Hamming distance 1
- */
-bool hd1(const string& lhs, const string& rhs) {
-   if (lhs.size() != rhs.size()) { return false; }
-   //else
-   int count = 0;
-   for (int i = 0; i < rhs.size(); i++) {
-      if (lhs.at(i) != rhs.at(i)) { count++; }
-   }
-   return count == 1;    //return count <= 1; to include equality.
-}
-
-/** Strings lhs and rhs have extension distance 1
-    REQ: neither string begins or ends with ASCII NUL, \0.
-    Strings differ by end-char delete if-and-only-if extending the shorter one
-    by '\0' makes them have Hamming distance 1.  And same for first-char delete.
- */
-bool xd1(const string& lhs, const string& rhs) {
-   if (lhs.size() == rhs.size()) { 
-      return hd1(lhs,rhs); 
-   } else if (lhs.size() == 1 + rhs.size()) {
-      return hd1(lhs, rhs + string('\0')) || hd1(lhs, string('\0') + rhs);
-   } else if (1 + lhs.size() == rhs.size()) {
-      return hd1(lhs + string('\0'), rhs) || hd1(string('\0') + lhs, rhs);
-   } else {
-      return false; //strings differ by 2 or more in length.
-   }
-}
-//Using a REQ to stipulate lhs.size() < rhs.size(0 would save only one
-//if-branch and 1 return line.  IMHO not worth it.
-
-/** 
-	Checks if two strings have edit distance 1.
- */
-bool ed1(const string& lhs, const string& rhs) {
-   int left = 0; 
-   int right;
-   if (lhs.size() == rhs.size()) {
-      return hd1(lhs,rhs);
-   } else if (lhs.size() == 1 + rhs.size()) {  //check for delete in first string
-      //LOOP INV: All chars to left of "left" match, and all to right of "right".
-      //Hence an extra char in lhs will eventually give right <= left.
-      right = lhs.size() - 1;
-      while (left < right && lhs.at(left) == rhs.at(left)) { left++; }
-      while (right > left && lhs.at(right) == rhs.at(right-1)) { right--; }
-      return right == left;  //all chars matched except this extra one.
-   } else if (1 + lhs.size() == rhs.size()) {  //check for delete in first string
-      //LOOP INV: All chars to left of "left" match, and all to right of "right".
-      //Hence an extra char in rhs will eventually give right <= left.
-      right = rhs.size() - 1;
-      while (left < right && lhs.at(left) == rhs.at(left)) { left++; }
-      while (right > left && lhs.at(right-1) == rhs.at(right)) { right--; }
-      return right == left;  //all chars matched except this extra one.
-   } else {
-      return false;
-   }
-}
-
-/**
-	Check for re-occurrence of a specific string in a chain
- */
-bool checkDuplicate(const StringWrap& word, int i, vector<PeekDeque<StringWrap>* >& chains) {
-	for (int k = chains.at(i)->returnFrontItem(); k < chains.at(i)->returnRearSpace(); k++) {
-		chains.at(i)->setPeekIndex(k);
-		
-		if(chains.at(i)->peek().str() == word.str()) {
-			return true;
-		}
-	}
-	return false;
-}
-
-/** 
-	Add word to a new or existing chain.
- */
-void testNewWord(const StringWrap& word, vector<PeekDeque<StringWrap>* >& chains, const bool& allowDuplicate, const bool& stepGrowth) {
-	bool foundChain = false;
-	bool isDuplicate;
-	
-	for(std::vector<int>::size_type i = 0; i != chains.size(); i++) { // check to see if we can add word into EXISTING chain
-		if(ed1(word.str(), chains.at(i)->returnFront().str()) && !foundChain) { // check front of chain
-			if(!allowDuplicate) {
-				isDuplicate = checkDuplicate(word, i, chains);
-				if(isDuplicate) {break;}
-			}
-			
-			if(stepGrowth && chains.at(i)->returnFront().str().length() >= word.str().length()) {
-				break;
-			}
-			
-			chains.at(i)->pushFront(word);
-			foundChain = true;
-			break;
-		}
-		
-		if(ed1(word.str(), chains.at(i)->returnRear().str()) && !foundChain) { // check rear of chain
-			if(!allowDuplicate) {
-				isDuplicate = checkDuplicate(word, i, chains);
-				if(isDuplicate) {break;}
-			}
-			
-			if(stepGrowth && chains.at(i)->returnRear().str().length() <= word.str().length()) {
-				break;
-			}
-			
-			chains.at(i)->pushRear(word);
-			foundChain = true;
-			break;
-		} 
-	}
-	
-	if(!foundChain) { // otherwise create a NEW chain
-		PeekDeque<StringWrap>* newpd = new PeekDeque<StringWrap>(1500);	// might need to adjust this to avoid seg fault on larger text files 
-		
-		newpd->pushFront(word);
-		
-		chains.push_back(newpd);
-	}
-}
-
-/** 
-	Lists all generated word chains.
- */
-void listAllChains(vector<PeekDeque<StringWrap>* >& chains) {
-	cout << "----------------------------------------------" << endl;
-	cout << "           LISTING ALL WORD CHAINS            " << endl;
-	cout << "----------------------------------------------" << endl;
-	
- 	for(std::vector<int>::size_type i = 0; i != chains.size(); i++) {
-		cout << "Chain #" << i << ": " << chains.at(i)->toString() << endl;
-	}
-}
-
-/** 
-	Lists the longest word chain(s).
-	The longest chain(s) is defined as the chain(s)
-	with the greatest amount of words in it.
- */
-void findLongestChain(vector<PeekDeque<StringWrap>* >& chains) {
-	size_t max = 0;
-	int maxIndex = 0;
-	vector<int> v;
-	
- 	for(std::vector<int>::size_type i = 0; i != chains.size(); i++) { // iterate through vector
-		if(chains.at(i)->size() == max) { // just in case we have a tie
-			v.push_back(i);
-		}
-		
-		if(chains.at(i)->size() > max) { // we have found a larger word chain breaking any previous ties
-			max = chains.at(i)->size();
-			maxIndex = i;
-			v.clear();
-			v.push_back(i);	
-		}
-	}
-	
-	cout << "----------------------------------------------" << endl;
-	cout << "          FINDING LONGEST WORD CHAIN          " << endl;
-	cout << "----------------------------------------------" << endl;
-	cout << "The longest chain(s) are: " << endl;
-	for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
-		cout << "    Chain #" << v[i] << ": " << chains.at(v[i])->toString() << endl;
-	}
-	cout << endl;
-	cout << "Each chain(s) contain " << chains.at(maxIndex)->size() << " total words.";
-}
-
-/** 
-	List the longest word(s) present in all chains.
-	The longest word is defined as the word that
-	has the greatest length().
- */
-void findLongestWord(vector<PeekDeque<StringWrap>* >& chains) {
-	int maxLength = 0;
-	int maxIndex;
-	string max;
-	vector<int> v;
-	
- 	for(std::vector<int>::size_type i = 0; i != chains.size(); i++) { // iterate through vector
-		chains.at(i)->setPeekToFront();
-		
-		for (int k = chains.at(i)->returnFrontItem(); k < chains.at(i)->returnRearSpace(); k++) { // loop through each PeekDeque
-			chains.at(i)->setPeekIndex(k);		
-			
-			if(chains.at(i)->peek().str().length() == maxLength) { // just in case we have a tie
-				maxLength = chains.at(i)->peek().str().length();
-				max = max + ", " + chains.at(i)->peek().str();
-				v.push_back(i);
-			}
-
-			if(chains.at(i)->peek().str().length() > maxLength) { // we have found a larger word breaking any previous ties
-				maxLength = chains.at(i)->peek().str().length();
-				max = chains.at(i)->peek().str();
-				v.clear();
-				v.push_back(i);
-			}
-		}
-	}
-	
-	cout << "----------------------------------------------" << endl;
-	cout << "            FINDING LONGEST STRING            " << endl;
-	cout << "----------------------------------------------" << endl;
-	cout << "The longest string(s) are: " << max << endl;
-	cout << endl;
-	cout << "The length of the longest string(s) are: " << maxLength << endl;
-	cout << endl;
-	cout << "The longest string(s) belong to the following word chain(s): " << endl;
-	for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
-		cout << "    Chain #" << v[i] << ": " << chains.at(v[i])->toString() << endl;
-	}
-	
-}
-
-/** 
-	Initializes program and runs the tests for assignment #5.
- */
-int main(int argc, char* argv[]){
-	
-	// parse command line arguments
-	string targetFile;
-	string boolAllowDuplicates;
-	string boolStepGrowth;
-	string boolLogFile; 
-	int filterLength = 0; // DEFAULT: 0
-	bool logFile = false; // DEFAULT: false
-	bool allowDuplicates = true; // DEFAULT: true
-	bool stepGrowth = false; // DEFAULT: false
-
-	for(int i = 1; i < argc; i++) {
-		if(string(argv[i]) == "--target-file") {
-			if(i + 1 < argc) {
-				targetFile = argv[++i];
-			}
-			else {
-				cerr << "--target-file option requires one argument [/path/to/file.txt]." << endl;
-				return 1;
-			}
-		}
-		
-		if(string(argv[i]) == "--log-file") {
-			if(i + 1 < argc) {
-				boolLogFile = argv[++i];
-			}
-			else {
-				cerr << "--log-file option requires one argument [true/false]." << endl;
-				return 1;
-			}
-		}
-		
-		if(string(argv[i]) == "--allow-duplicates") {
-			if(i + 1 < argc) {
-				boolAllowDuplicates = argv[++i];
-			}
-			else {
-				cerr << "--allow-duplicates option requires one argument [true/false]." << endl;
-				return 1;
-			}
-		}
-		
-		if(string(argv[i]) == "--step-growth") {
-			if(i + 1 < argc) {
-				boolStepGrowth = argv[++i];
-			}
-			else {
-				cerr << "--step-growth option requires one argument [true/false]." << endl;
-				return 1;
-			}
-		}
-		
-		if(string(argv[i]) == "--filter-length") {
-			if(i + 1 < argc) {
-				filterLength = atoi(argv[++i]);
-			}
-			else {
-				cerr << "--filter-length option requires one argument [integer]." << endl;
-				return 1;
-			}
-		}
-	}
-	
-	// convert string to bool
-	StringWrap sw1(boolAllowDuplicates);
-	sw1.makeLower();
-	StringWrap sw2(boolStepGrowth);
-	sw2.makeLower();
-	StringWrap sw3(boolLogFile);
-	sw3.makeLower();
-	
-	if(sw1.str() == "false") {
-		allowDuplicates = false;
-	} else if(sw1.str() == "true") {
-		allowDuplicates = true;
-	}
-	
-	if(sw2.str() == "false") {
-		stepGrowth = false;
-	} else if(sw2.str() == "true") {
-		stepGrowth = true;
-	}
-	
-	if(sw3.str() == "false") {
-		logFile = false;
-	} else if(sw3.str() == "true") {
-		logFile = true;
-	}
-	
-	// show usage instructions if needed
-	if(argc == 1 || argc > 11 || targetFile == "") {
-		cout << argv[0] << ": A word chain generator created by Robert Shannon (rshannon@buffalo.edu) for Dr. Regan's CSE 250 course at University at Buffalo." << endl << endl;
-		cout << "Usage:" << argv[0] << " [OPTIONS] command command..." << endl;
-		cout << "        " << "--target-file [/path/to/file.txt]" << endl << "        File to read words from. REQUIRED." << endl << endl; 
-		cout << "        " << "--log-file [true/false]" << endl << "        Stores all output into a file called chain_log.txt in current working directory. Recommended when using large target files. DEFAULT VALUE: false. OPTIONAL." << endl << endl; 
-		cout << "        " << "--allow-duplicates [true/false]" << endl << "        Prevents adding a word to a chain more than once. Caveat: can have drastic impact on run time when processing large text files. DEFAULT VALUE: true. OPTIONAL." << endl << endl; 
-		cout << "        " << "--step-growth [true/false]" << endl << "        Sets whether chains should grow at each step when being constructed. e.g. farm-form-for-nor-or. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
-		cout << "        " << "--filter-length [integer]" << endl << "        Filter out words that have a length less than or equal to the specified value. DEFAULT VALUE: 0. OPTIONAL." << endl << endl;
-		return 1;
-	}
-	
-	// execute program according to command line arguments
-	if(logFile == true){ 
-		cout << "Saving output to file " << "chain_log.txt" << "." << endl; 
-		freopen("chain_log.txt","w",stdout); 
-	}
-	
-    vector<PeekDeque<StringWrap>* > chains;
-
-	string word;
-
-    string infileName = targetFile;
-    ifstream INFILEp(infileName.c_str(), ios_base::in);
-
-	if(INFILEp.fail()) { // file could not be opened
-		cerr << "The specified target file " << targetFile << " does not exist or cannot be found. Please try again.";
-		return 1;
-	}
-	
-    while ((INFILEp) >> word) { // read in words from file
-		StringWrap sw(word); 
-		sw.trimNonAlpha(); // strip punctuation
-
-		if(sw.isAlpha() && sw.str().length() > filterLength) { // let's only deal with words consisting of a-z and/or A-Z, and greater than target length
-			sw.makeLower();
-			testNewWord(sw, chains, allowDuplicates, stepGrowth);
-		}
-    }
-   
-    INFILEp.close();
-	
-	listAllChains(chains); 
-	cout << endl << endl;
-	findLongestChain(chains);
-	cout << endl << endl;
-	findLongestWord(chains);
-	
-	if(logFile == true){ 
-		fclose(stdout); 
-	}
-	
-}
-
-
-      
+/** 	
+	@name WordChainGenerator.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	A word chain generator written in C++ for Dr. Regan's CSE 250
+	Course at University at Buffalo.
+ */
+
+#include "ChainBuilder.h"
+#include "ChainStream.h"
+#include "ChainServer.h"
+#include "WordGraph.h"
+#include "ReportWriter.h"
+#include "Snapshot.h"
+#include "FilePipeline.h"
+#include "StringWrap.h"
+#include "Profile.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+/** 
+	Write the words of a chain in the selected format: space separated
+	text, a JSON array, or a count followed by length-prefixed words.
+	Words are lowercase letters only, so JSON needs no escaping.
+ */
+void writeWords(ReportWriter& out, const Chain& chain, const WordPool& pool, OutputFormat format) {
+	if(format == BINARY) {
+		out.writeUint32(chain.size());
+		for(size_t k = 0; k != chain.size(); k++) {
+			string_view word = pool.str(chain.item(k));
+			out.writeUint32(word.size());
+			out << word;
+		}
+	} else if(format == NDJSON) {
+		out << '[';
+		for(size_t k = 0; k != chain.size(); k++) {
+			out << (k ? ",\"" : "\"") << pool.str(chain.item(k)) << '"';
+		}
+		out << ']';
+	} else {
+		for(size_t k = 0; k != chain.size(); k++) {
+			out << pool.str(chain.item(k)) << ' ';
+		}
+	}
+}
+
+/** 
+	Write a list of chain numbers as a JSON array or a counted binary list.
+ */
+void writeIndexes(ReportWriter& out, const vector<int>& v, OutputFormat format) {
+	if(format == BINARY) {
+		out.writeUint32(v.size());
+		for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
+			out.writeUint32(v[i]);
+		}
+	} else {
+		out << '[';
+		for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
+			out << (i ? "," : "") << v[i];
+		}
+		out << ']';
+	}
+}
+
+/** 
+	Lists all generated word chains.
+ */
+void listAllChains(const vector<Chain* >& chains, const WordPool& pool, ReportWriter& out, OutputFormat format) {
+	if(format == BINARY) {
+		out << "WCGB";
+		out.writeUint32(2); // format version
+		out << 'C';
+		out.writeUint32(chains.size());
+		for(std::vector<int>::size_type i = 0; i != chains.size(); i++) {
+			writeWords(out, *chains[i], pool, format);
+		}
+		return;
+	}
+	if(format == NDJSON) {
+		for(std::vector<int>::size_type i = 0; i != chains.size(); i++) {
+			out << "{\"type\":\"chain\",\"id\":" << i << ",\"length\":" << chains[i]->size() << ",\"words\":";
+			writeWords(out, *chains[i], pool, format);
+			out << "}\n";
+		}
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "           LISTING ALL WORD CHAINS            \n";
+	out << "----------------------------------------------\n";
+	
+ 	for(std::vector<int>::size_type i = 0; i != chains.size(); i++) {
+		out << "Chain #" << i << ": ";
+		writeWords(out, *chains[i], pool, format);
+		out << '\n';
+	}
+}
+
+/** 
+	Lists the longest word chain(s).
+	The longest chain(s) is defined as the chain(s)
+	with the greatest amount of words in it.
+ */
+void findLongestChain(const vector<Chain* >& chains, const ChainStats& stats, const WordPool& pool, ReportWriter& out, OutputFormat format) {
+	size_t max = stats.longestChainLength();
+	vector<int> v = stats.longestChainIndexes();
+	
+	if(format == BINARY) {
+		out << 'L';
+		out.writeUint32(max);
+		writeIndexes(out, v, format);
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"longest_chains\",\"length\":" << max << ",\"ids\":";
+		writeIndexes(out, v, format);
+		out << "}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "          FINDING LONGEST WORD CHAIN          \n";
+	out << "----------------------------------------------\n";
+	out << "The longest chain(s) are: \n";
+	for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
+		out << "    Chain #" << v[i] << ": ";
+		writeWords(out, *chains.at(v[i]), pool, format);
+		out << '\n';
+	}
+	out << '\n';
+	out << "Each chain(s) contain " << max << " total words.";
+}
+
+/** 
+	List the longest word(s) present in all chains.
+	The longest word is defined as the word that
+	has the greatest length().
+ */
+void findLongestWord(const vector<Chain* >& chains, const ChainStats& stats, const WordPool& pool, ReportWriter& out, OutputFormat format) {
+	size_t maxLength = stats.longestWordLength();
+	vector<int> holders = stats.longestWordChains();
+	vector<uint32_t> max;
+	vector<int> v;
+	
+ 	for(std::vector<int>::size_type i = 0; i != holders.size(); i++) { // only the chains known to hold a longest word
+		const Chain& chain = *chains[holders[i]];
+		
+		for (size_t k = 0; k != chain.size(); k++) {
+			if(pool.length(chain.item(k)) == maxLength) {
+				max.push_back(chain.item(k));
+				v.push_back(holders[i]);
+			}
+		}
+	}
+	
+	if(format == BINARY) {
+		out << 'W';
+		out.writeUint32(maxLength);
+		out.writeUint32(max.size());
+		for(std::vector<uint32_t>::size_type k = 0; k != max.size(); k++) {
+			out.writeUint32(pool.length(max[k]));
+			out << pool.str(max[k]);
+		}
+		writeIndexes(out, v, format);
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"longest_words\",\"length\":" << maxLength << ",\"words\":[";
+		for(std::vector<uint32_t>::size_type k = 0; k != max.size(); k++) {
+			out << (k ? ",\"" : "\"") << pool.str(max[k]) << '"';
+		}
+		out << "],\"ids\":";
+		writeIndexes(out, v, format);
+		out << "}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "            FINDING LONGEST STRING            \n";
+	out << "----------------------------------------------\n";
+	out << "The longest string(s) are: ";
+	for(std::vector<uint32_t>::size_type k = 0; k != max.size(); k++) {
+		out << (k ? ", " : "") << pool.str(max[k]);
+	}
+	out << '\n';
+	out << '\n';
+	out << "The length of the longest string(s) are: " << maxLength << '\n';
+	out << '\n';
+	out << "The longest string(s) belong to the following word chain(s): \n";
+	for(std::vector<int>::size_type i = 0; i != v.size(); i++) {
+		out << "    Chain #" << v[i] << ": ";
+		writeWords(out, *chains.at(v[i]), pool, format);
+		out << '\n';
+	}
+	
+}
+
+/** 
+	List the longest chain in the edit-distance-one graph of all words,
+	rather than the longest chain the greedy builder happened to make.
+	With step growth the graph is a DAG and the answer is exact;
+	otherwise it comes from a budgeted branch-and-bound search.
+ */
+void findLongestPath(const WordPool& pool, const bool& stepGrowth, int threads, long searchTime, uint64_t searchNodes, ReportWriter& out, OutputFormat format) {
+	WordGraph graph(pool);
+	PathSearch result = stepGrowth ? longestGrowthPath(graph, pool) : longestSimplePath(graph, threads, searchTime, searchNodes);
+	
+	if(format == BINARY) {
+		out << 'P' << (char)result.exhaustive;
+		out.writeUint32(result.path.size());
+		for(std::vector<uint32_t>::size_type k = 0; k != result.path.size(); k++) {
+			out.writeUint32(pool.length(result.path[k]));
+			out << pool.str(result.path[k]);
+		}
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"longest_path\",\"vertices\":" << graph.vertices() << ",\"edges\":" << graph.edges()
+		    << ",\"exhaustive\":" << (result.exhaustive ? "true" : "false") << ",\"nodes\":" << result.nodes << ",\"words\":[";
+		for(std::vector<uint32_t>::size_type k = 0; k != result.path.size(); k++) {
+			out << (k ? ",\"" : "\"") << pool.str(result.path[k]) << '"';
+		}
+		out << "]}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "        FINDING LONGEST PATH IN WORD GRAPH     \n";
+	out << "----------------------------------------------\n";
+	out << "The word graph has " << graph.vertices() << " words and " << graph.edges() << " edges.\n";
+	out << '\n';
+	out << "The longest path is: ";
+	for(std::vector<uint32_t>::size_type k = 0; k != result.path.size(); k++) {
+		out << pool.str(result.path[k]) << ' ';
+	}
+	out << "\n\n";
+	out << "The path contains " << result.path.size() << " total words.\n";
+	if(result.exhaustive) {
+		out << "The search was exhaustive, so no longer path exists.\n";
+	} else {
+		out << "The search budget ran out after " << result.nodes << " nodes; a longer path may exist.\n";
+	}
+}
+
+/** 
+	Report how many distinct words were interned, the memory they and
+	the chain arena use, and the peak resident memory of the run.
+ */
+void reportWordPool(const WordPool& pool, size_t wordCount, const ChainArena& arena, ReportWriter& out, OutputFormat format) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	
+	if(format == BINARY) {
+		out << 'S';
+		out.writeUint64(wordCount);
+		out.writeUint32(pool.size());
+		out.writeUint64(pool.bytes());
+		out.writeUint64(arena.bytes());
+		out.writeUint64(usage.ru_maxrss);
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"word_pool\",\"words\":" << wordCount << ",\"unique\":" << pool.size() << ",\"bytes\":" << pool.bytes()
+		    << ",\"chain_bytes\":" << arena.bytes() << ",\"peak_rss_kb\":" << usage.ru_maxrss << "}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "              WORD POOL STATISTICS            \n";
+	out << "----------------------------------------------\n";
+	out << "Words added to chains: " << wordCount << '\n';
+	out << "Unique words: " << pool.size() << '\n';
+	out << "Word pool memory: " << pool.bytes() << " bytes\n";
+	out << "Chain arena memory: " << arena.bytes() << " bytes\n";
+	out << "Peak resident memory: " << usage.ru_maxrss << " KB\n";
+}
+
+/** 
+	Report the chain-length and word-length histograms.
+ */
+void reportStatistics(const ChainStats& stats, ReportWriter& out, OutputFormat format) {
+	const vector<size_t>& chainLengths = stats.chainLengthHistogram();
+	const vector<size_t>& wordLengths = stats.wordLengthHistogram();
+	
+	if(format == BINARY) {
+		out << 'H';
+		out.writeUint32(stats.uniqueWordCount());
+		out.writeUint32(chainLengths.size());
+		for(std::vector<size_t>::size_type k = 0; k != chainLengths.size(); k++) { out.writeUint32(chainLengths[k]); }
+		out.writeUint32(wordLengths.size());
+		for(std::vector<size_t>::size_type k = 0; k != wordLengths.size(); k++) { out.writeUint32(wordLengths[k]); }
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"statistics\",\"unique_in_chains\":" << stats.uniqueWordCount() << ",\"chain_lengths\":[";
+		for(std::vector<size_t>::size_type k = 0; k != chainLengths.size(); k++) { out << (k ? "," : "") << chainLengths[k]; }
+		out << "],\"word_lengths\":[";
+		for(std::vector<size_t>::size_type k = 0; k != wordLengths.size(); k++) { out << (k ? "," : "") << wordLengths[k]; }
+		out << "]}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "               CHAIN STATISTICS               \n";
+	out << "----------------------------------------------\n";
+	out << "Unique words in chains: " << stats.uniqueWordCount() << '\n';
+	out << '\n';
+	out << "Chains by length (words: chains):\n";
+	for(std::vector<size_t>::size_type k = 0; k != chainLengths.size(); k++) {
+		if(chainLengths[k] != 0) { out << "    " << k << ": " << chainLengths[k] << '\n'; }
+	}
+	out << '\n';
+	out << "Words by length (letters: words):\n";
+	for(std::vector<size_t>::size_type k = 0; k != wordLengths.size(); k++) {
+		if(wordLengths[k] != 0) { out << "    " << k << ": " << wordLengths[k] << '\n'; }
+	}
+}
+
+/** 
+	Report how fast each file was read and tokenized, and the words per
+	second for the whole run of files including chain building.
+ */
+void reportThroughput(const vector<FileThroughput>& files, double seconds, ReportWriter& out, OutputFormat format) {
+	uint64_t bytes = 0;
+	uint64_t words = 0;
+	for(std::vector<FileThroughput>::size_type f = 0; f != files.size(); f++) {
+		bytes += files[f].bytes;
+		words += files[f].words;
+	}
+	
+	if(format == BINARY) {
+		out << 'T';
+		out.writeUint32(files.size());
+		for(std::vector<FileThroughput>::size_type f = 0; f != files.size(); f++) {
+			out.writeUint32(files[f].path.size());
+			out << files[f].path;
+			out.writeUint64(files[f].bytes);
+			out.writeUint64(files[f].words);
+			out.writeUint64(files[f].seconds * 1e6);
+		}
+		out.writeUint64(seconds * 1e6);
+		return;
+	}
+	if(format == NDJSON) {
+		for(std::vector<FileThroughput>::size_type f = 0; f != files.size(); f++) {
+			out << "{\"type\":\"file\",\"path\":\"";
+			for(size_t k = 0; k != files[f].path.size(); k++) { // paths may need escaping, words never do
+				char c = files[f].path[k];
+				if(c == '"' || c == '\\') { out << '\\'; }
+				if((unsigned char)c >= 0x20) { out << c; }
+			}
+			out << "\",\"opened\":" << (files[f].opened ? "true" : "false") << ",\"bytes\":" << files[f].bytes
+			    << ",\"words\":" << files[f].words << ",\"microseconds\":" << (uint64_t)(files[f].seconds * 1e6) << "}\n";
+		}
+		out << "{\"type\":\"throughput\",\"files\":" << files.size() << ",\"bytes\":" << bytes << ",\"words\":" << words
+		    << ",\"microseconds\":" << (uint64_t)(seconds * 1e6) << ",\"words_per_second\":" << (seconds > 0 ? words / seconds : 0.0) << "}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "               FILE THROUGHPUT                \n";
+	out << "----------------------------------------------\n";
+	for(std::vector<FileThroughput>::size_type f = 0; f != files.size(); f++) {
+		out << files[f].path << ": ";
+		if(!files[f].opened) {
+			out << "could not be opened\n";
+			continue;
+		}
+		out << files[f].words << " words, " << files[f].bytes << " bytes read in " << files[f].seconds * 1000 << " ms";
+		if(files[f].seconds > 0) {
+			out << " (" << files[f].bytes / files[f].seconds / 1e6 << " MB/s)";
+		}
+		out << '\n';
+	}
+	out << '\n';
+	out << "All files: " << words << " words, " << bytes << " bytes in " << seconds * 1000 << " ms";
+	if(seconds > 0) {
+		out << " (" << words / seconds << " words/s)";
+	}
+	out << '\n';
+}
+
+/** 
+	Report a --neighbors query: the words within distance one of word
+	and the chains with an end at one of them.
+ */
+void reportNeighbors(const string& word, const vector<uint32_t>& found, const vector<int>& ends, const WordPool& pool, ReportWriter& out, OutputFormat format) {
+	if(format == BINARY) {
+		out << 'N';
+		out.writeUint32(word.size());
+		out << word;
+		out.writeUint32(found.size());
+		for(std::vector<uint32_t>::size_type k = 0; k != found.size(); k++) {
+			out.writeUint32(pool.length(found[k]));
+			out << pool.str(found[k]);
+		}
+		out.writeUint32(ends.size());
+		for(std::vector<int>::size_type k = 0; k != ends.size(); k++) {
+			out.writeUint32(ends[k]);
+		}
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"neighbors\",\"word\":\"" << word << "\",\"words\":[";
+		for(std::vector<uint32_t>::size_type k = 0; k != found.size(); k++) {
+			out << (k ? ",\"" : "\"") << pool.str(found[k]) << '"';
+		}
+		out << "],\"chains\":[";
+		for(std::vector<int>::size_type k = 0; k != ends.size(); k++) {
+			out << (k ? "," : "") << ends[k];
+		}
+		out << "]}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "                  NEIGHBORS                   \n";
+	out << "----------------------------------------------\n";
+	out << "Words within distance one of " << word << ": " << found.size() << '\n';
+	for(std::vector<uint32_t>::size_type k = 0; k != found.size(); k++) {
+		out << "    " << pool.str(found[k]) << '\n';
+	}
+	out << '\n';
+	out << "Chains with an end at one of them: " << ends.size() << '\n';
+	for(std::vector<int>::size_type k = 0; k != ends.size(); k++) {
+		out << "    Chain #" << ends[k] << '\n';
+	}
+}
+
+/** 
+	Report the word counts from the --min-frequency pre-pass: how many
+	words were read, how many distinct words there were and how many
+	were frequent enough to be used, and the ten most frequent words.
+ */
+void reportFrequency(const vector<uint32_t>& counts, const WordPool& pool, uint32_t minFrequency, ReportWriter& out, OutputFormat format) {
+	uint64_t words = 0;
+	uint32_t distinct = 0;
+	uint32_t used = 0;
+	uint32_t once = 0;
+	vector<uint32_t> ids;
+	for(std::vector<uint32_t>::size_type id = 0; id != counts.size(); id++) {
+		if(counts[id] == 0) { continue; }
+		words += counts[id];
+		distinct++;
+		used += counts[id] >= minFrequency;
+		once += counts[id] == 1;
+		ids.push_back(id);
+	}
+	size_t shown = min<size_t>(10, ids.size());
+	partial_sort(ids.begin(), ids.begin() + shown, ids.end(), [&](uint32_t a, uint32_t b) {
+		return counts[a] != counts[b] ? counts[a] > counts[b] : a < b; // ties in order of first appearance
+	});
+	
+	if(format == BINARY) {
+		out << 'F';
+		out.writeUint64(words);
+		out.writeUint32(distinct);
+		out.writeUint32(used);
+		out.writeUint32(minFrequency);
+		out.writeUint32(once);
+		out.writeUint32(shown);
+		for(size_t k = 0; k < shown; k++) {
+			out.writeUint32(pool.length(ids[k]));
+			out << pool.str(ids[k]);
+			out.writeUint32(counts[ids[k]]);
+		}
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"frequency\",\"words\":" << words << ",\"distinct\":" << distinct << ",\"used\":" << used
+		    << ",\"min_frequency\":" << minFrequency << ",\"once\":" << once << ",\"top\":[";
+		for(size_t k = 0; k < shown; k++) {
+			out << (k ? "," : "") << "{\"word\":\"" << pool.str(ids[k]) << "\",\"count\":" << counts[ids[k]] << '}';
+		}
+		out << "]}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "                WORD FREQUENCY                \n";
+	out << "----------------------------------------------\n";
+	out << "Words read: " << words << '\n';
+	out << "Distinct words: " << distinct << '\n';
+	out << "Words seen once: " << once << '\n';
+	out << "Words used (seen at least " << minFrequency << (minFrequency == 1 ? " time): " : " times): ") << used << '\n';
+	out << '\n';
+	out << "Most frequent words:\n";
+	for(size_t k = 0; k < shown; k++) {
+		out << "    " << pool.str(ids[k]) << ": " << counts[ids[k]] << '\n';
+	}
+}
+
+/** 
+	Report the --stats counters and the time spent in each phase. In a
+	build without profiling every value is zero.
+ */
+void reportProfile(ReportWriter& out, OutputFormat format) {
+	if(format == BINARY) {
+		out << 'R';
+		out.writeUint32(COUNTER_COUNT);
+		for(int c = 0; c != COUNTER_COUNT; c++) { out.writeUint64(profileTotal(Counter(c))); }
+		out.writeUint32(PHASE_COUNT);
+		for(int p = 0; p != PHASE_COUNT; p++) { out.writeUint64(phaseNanoseconds(Phase(p))); }
+		return;
+	}
+	if(format == NDJSON) {
+		out << "{\"type\":\"profile\",\"enabled\":" << (PROFILING ? "true" : "false");
+		for(int c = 0; c != COUNTER_COUNT; c++) { out << ",\"" << counterName(Counter(c)) << "\":" << profileTotal(Counter(c)); }
+		out << ",\"phase_microseconds\":{";
+		for(int p = 0; p != PHASE_COUNT; p++) { out << (p ? "," : "") << '"' << phaseName(Phase(p)) << "\":" << phaseNanoseconds(Phase(p)) / 1000; }
+		out << "}}\n";
+		return;
+	}
+	
+	out << "----------------------------------------------\n";
+	out << "                   PROFILE                    \n";
+	out << "----------------------------------------------\n";
+	if(!PROFILING) {
+		out << "Profiling was compiled out (PROFILE=0).\n";
+		return;
+	}
+	for(int c = 0; c != COUNTER_COUNT; c++) {
+		out << counterName(Counter(c)) << ": " << profileTotal(Counter(c)) << '\n';
+	}
+	out << '\n';
+	for(int p = 0; p != PHASE_COUNT; p++) {
+		out << phaseName(Phase(p)) << ": " << phaseNanoseconds(Phase(p)) / 1e6 << " ms\n";
+	}
+}
+
+/** 
+	Initializes program and runs the tests for assignment #5.
+ */
+int main(int argc, char* argv[]){
+	
+	// parse command line arguments
+	string targetFile;
+	string boolAllowDuplicates;
+	string boolStepGrowth;
+	string boolLogFile; 
+	string boolDeterministic;
+	string boolLongestPath;
+	string boolStream;
+	string boolStats;
+	string boolMergeChains;
+	string formatName;
+	string saveState;
+	string targetFiles;
+	string targetDir;
+	string distanceName;
+	string loadState;
+	string neighborsOf;
+	string servePath;
+	int filterLength = 0; // DEFAULT: 0
+	int threads = 1; // DEFAULT: 1
+	long searchTime = 10000; // DEFAULT: 10000
+	uint64_t searchNodes = 100000000; // DEFAULT: 100000000
+	size_t memoryLimit = 256; // DEFAULT: 256
+	uint64_t snapshotEvery = 1000000; // DEFAULT: 1000000
+	size_t top = 10; // DEFAULT: 10
+	uint32_t minFrequency = 0; // DEFAULT: 0
+	int serveThreads = 4; // DEFAULT: 4
+	bool logFile = false; // DEFAULT: false
+	bool allowDuplicates = true; // DEFAULT: true
+	bool stepGrowth = false; // DEFAULT: false
+	bool deterministic = false; // DEFAULT: false
+	bool longestPath = false; // DEFAULT: false
+	bool stream = false; // DEFAULT: false
+	bool showStats = false; // DEFAULT: false
+	bool mergeChainEnds = false; // DEFAULT: false
+	OutputFormat outputFormat = TEXT; // DEFAULT: text
+	Metric metric = EDIT; // DEFAULT: ed
+
+	for(int i = 1; i < argc; i++) {
+		if(string(argv[i]) == "--target-file") {
+			if(i + 1 < argc) {
+				targetFile = argv[++i];
+			}
+			else {
+				cerr << "--target-file option requires one argument [/path/to/file.txt]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--target-files") {
+			if(i + 1 < argc) {
+				targetFiles = argv[++i];
+			}
+			else {
+				cerr << "--target-files option requires one argument [file1.txt,file2.txt,...]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--target-dir") {
+			if(i + 1 < argc) {
+				targetDir = argv[++i];
+			}
+			else {
+				cerr << "--target-dir option requires one argument [/path/to/directory]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--log-file") {
+			if(i + 1 < argc) {
+				boolLogFile = argv[++i];
+			}
+			else {
+				cerr << "--log-file option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--allow-duplicates") {
+			if(i + 1 < argc) {
+				boolAllowDuplicates = argv[++i];
+			}
+			else {
+				cerr << "--allow-duplicates option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--step-growth") {
+			if(i + 1 < argc) {
+				boolStepGrowth = argv[++i];
+			}
+			else {
+				cerr << "--step-growth option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--distance") {
+			if(i + 1 < argc) {
+				distanceName = argv[++i];
+			}
+			else {
+				cerr << "--distance option requires one argument [hd/xd/ed]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--filter-length") {
+			if(i + 1 < argc) {
+				filterLength = atoi(argv[++i]);
+			}
+			else {
+				cerr << "--filter-length option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--threads") {
+			if(i + 1 < argc) {
+				threads = atoi(argv[++i]);
+			}
+			else {
+				cerr << "--threads option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--deterministic") {
+			if(i + 1 < argc) {
+				boolDeterministic = argv[++i];
+			}
+			else {
+				cerr << "--deterministic option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--longest-path") {
+			if(i + 1 < argc) {
+				boolLongestPath = argv[++i];
+			}
+			else {
+				cerr << "--longest-path option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--search-time") {
+			if(i + 1 < argc) {
+				searchTime = atol(argv[++i]);
+			}
+			else {
+				cerr << "--search-time option requires one argument [milliseconds]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--search-nodes") {
+			if(i + 1 < argc) {
+				searchNodes = strtoull(argv[++i], NULL, 10);
+			}
+			else {
+				cerr << "--search-nodes option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--stream") {
+			if(i + 1 < argc) {
+				boolStream = argv[++i];
+			}
+			else {
+				cerr << "--stream option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--stats") {
+			if(i + 1 < argc) {
+				boolStats = argv[++i];
+			}
+			else {
+				cerr << "--stats option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--merge-chains") {
+			if(i + 1 < argc) {
+				boolMergeChains = argv[++i];
+			}
+			else {
+				cerr << "--merge-chains option requires one argument [true/false]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--memory-limit") {
+			if(i + 1 < argc) {
+				memoryLimit = strtoull(argv[++i], NULL, 10);
+			}
+			else {
+				cerr << "--memory-limit option requires one argument [megabytes]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--snapshot-every") {
+			if(i + 1 < argc) {
+				snapshotEvery = strtoull(argv[++i], NULL, 10);
+			}
+			else {
+				cerr << "--snapshot-every option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--min-frequency") {
+			if(i + 1 < argc) {
+				minFrequency = strtoul(argv[++i], NULL, 10);
+			}
+			else {
+				cerr << "--min-frequency option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--neighbors") {
+			if(i + 1 < argc) {
+				neighborsOf = argv[++i];
+			}
+			else {
+				cerr << "--neighbors option requires one argument [word]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--serve") {
+			if(i + 1 < argc) {
+				servePath = argv[++i];
+			}
+			else {
+				cerr << "--serve option requires one argument [stdin or /path/to/socket]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--serve-threads") {
+			if(i + 1 < argc) {
+				serveThreads = atoi(argv[++i]);
+			}
+			else {
+				cerr << "--serve-threads option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--top") {
+			if(i + 1 < argc) {
+				top = strtoull(argv[++i], NULL, 10);
+			}
+			else {
+				cerr << "--top option requires one argument [integer]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--output-format") {
+			if(i + 1 < argc) {
+				formatName = argv[++i];
+			}
+			else {
+				cerr << "--output-format option requires one argument [text/ndjson/binary]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--save-state") {
+			if(i + 1 < argc) {
+				saveState = argv[++i];
+			}
+			else {
+				cerr << "--save-state option requires one argument [/path/to/state]." << endl;
+				return 1;
+			}
+		}
+		
+		if(string(argv[i]) == "--load-state") {
+			if(i + 1 < argc) {
+				loadState = argv[++i];
+			}
+			else {
+				cerr << "--load-state option requires one argument [/path/to/state]." << endl;
+				return 1;
+			}
+		}
+	}
+	
+	// convert string to bool
+	StringWrap sw1(boolAllowDuplicates);
+	sw1.makeLower();
+	StringWrap sw2(boolStepGrowth);
+	sw2.makeLower();
+	StringWrap sw3(boolLogFile);
+	sw3.makeLower();
+	StringWrap sw4(boolDeterministic);
+	sw4.makeLower();
+	StringWrap sw5(boolLongestPath);
+	sw5.makeLower();
+	StringWrap sw6(boolStream);
+	sw6.makeLower();
+	StringWrap sw7(formatName);
+	sw7.makeLower();
+	StringWrap sw8(distanceName);
+	sw8.makeLower();
+	StringWrap sw9(boolStats);
+	sw9.makeLower();
+	StringWrap sw10(boolMergeChains);
+	sw10.makeLower();
+	StringWrap sw11(neighborsOf);
+	sw11.makeLower();
+	
+	if(sw1.str() == "false") {
+		allowDuplicates = false;
+	} else if(sw1.str() == "true") {
+		allowDuplicates = true;
+	}
+	
+	if(sw2.str() == "false") {
+		stepGrowth = false;
+	} else if(sw2.str() == "true") {
+		stepGrowth = true;
+	}
+	
+	if(sw3.str() == "false") {
+		logFile = false;
+	} else if(sw3.str() == "true") {
+		logFile = true;
+	}
+	
+	if(sw4.str() == "false") {
+		deterministic = false;
+	} else if(sw4.str() == "true") {
+		deterministic = true;
+	}
+	
+	if(sw5.str() == "false") {
+		longestPath = false;
+	} else if(sw5.str() == "true") {
+		longestPath = true;
+	}
+	
+	if(sw6.str() == "false") {
+		stream = false;
+	} else if(sw6.str() == "true") {
+		stream = true;
+	}
+	
+	if(sw9.str() == "false") {
+		showStats = false;
+	} else if(sw9.str() == "true") {
+		showStats = true;
+	}
+	
+	if(sw10.str() == "false") {
+		mergeChainEnds = false;
+	} else if(sw10.str() == "true") {
+		mergeChainEnds = true;
+	}
+	
+	if(sw8.str() == "hd") {
+		metric = HAMMING;
+	} else if(sw8.str() == "xd") {
+		metric = EXTENSION;
+	} else if(sw8.str() != "" && sw8.str() != "ed") {
+		cerr << "--distance must be one of hd, xd or ed." << endl;
+		return 1;
+	}
+	
+	if(sw7.str() == "ndjson") {
+		outputFormat = NDJSON;
+	} else if(sw7.str() == "binary") {
+		outputFormat = BINARY;
+	} else if(sw7.str() != "" && sw7.str() != "text") {
+		cerr << "--output-format must be one of text, ndjson or binary." << endl;
+		return 1;
+	}
+	
+	if(neighborsOf != "" && !WordTrie::isWord(sw11.str())) {
+		cerr << "--neighbors must be a word made of the letters a-z." << endl;
+		return 1;
+	}
+	
+	if(threads < 1) {
+		threads = 1;
+	}
+	
+	// show usage instructions if needed
+	if(argc == 1 || argc > 53 || (targetFile == "" && targetFiles == "" && targetDir == "" && loadState == "")) {
+		cout << argv[0] << ": A word chain generator created by Robert Shannon (rshannon@buffalo.edu) for Dr. Regan's CSE 250 course at University at Buffalo." << endl << endl;
+		cout << "Usage:" << argv[0] << " [OPTIONS] command command..." << endl;
+		cout << "        " << "--target-file [/path/to/file.txt]" << endl << "        File to read words from. REQUIRED unless --target-files, --target-dir or --load-state is given." << endl << endl; 
+		cout << "        " << "--target-files [file1.txt,file2.txt,...]" << endl << "        Comma-separated files to read, in order, into one set of chains. Files are read on --threads I/O threads while chains are built, and per-file throughput is reported. OPTIONAL." << endl << endl;
+		cout << "        " << "--target-dir [/path/to/directory]" << endl << "        Read every file in a directory, in name order, as with --target-files. OPTIONAL." << endl << endl;
+		cout << "        " << "--log-file [true/false]" << endl << "        Stores all output into a file called chain_log.txt in current working directory. Recommended when using large target files. DEFAULT VALUE: false. OPTIONAL." << endl << endl; 
+		cout << "        " << "--allow-duplicates [true/false]" << endl << "        Prevents adding a word to a chain more than once. DEFAULT VALUE: true. OPTIONAL." << endl << endl; 
+		cout << "        " << "--step-growth [true/false]" << endl << "        Sets whether chains should grow at each step when being constructed. e.g. farm-form-for-nor-or. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		cout << "        " << "--distance [hd/xd/ed]" << endl << "        Distance between neighboring words in a chain: Hamming (one letter changed), extension (one letter changed, or added at either end) or edit (one letter changed, added or removed anywhere). DEFAULT VALUE: ed. OPTIONAL." << endl << endl;
+		cout << "        " << "--filter-length [integer]" << endl << "        Filter out words that have a length less than or equal to the specified value. DEFAULT VALUE: 0. OPTIONAL." << endl << endl;
+		cout << "        " << "--threads [integer]" << endl << "        Number of threads used to read the target file and build chains. With more than one thread, chains are built in shards by word length and never mix words from different shards. DEFAULT VALUE: 1. OPTIONAL." << endl << endl;
+		cout << "        " << "--deterministic [true/false]" << endl << "        With --threads, only read the target file in parallel and build chains serially, so the output is identical to a single-threaded run. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		cout << "        " << "--longest-path [true/false]" << endl << "        Also search the graph of all words for the longest possible chain. With --step-growth the answer is exact; otherwise the search runs on --threads threads within the budget below. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		cout << "        " << "--search-time [milliseconds]" << endl << "        Time budget for --longest-path. DEFAULT VALUE: 10000. OPTIONAL." << endl << endl;
+		cout << "        " << "--search-nodes [integer]" << endl << "        Node budget for --longest-path. DEFAULT VALUE: 100000000. OPTIONAL." << endl << endl;
+		cout << "        " << "--stream [true/false]" << endl << "        Build chains incrementally with bounded memory and report the longest chains and words seen so far instead of listing every chain. Reads one --target-file, or standard input with --target-file -; --target-files and --target-dir are rejected. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		cout << "        " << "--memory-limit [megabytes]" << endl << "        With --stream, retire the chains that have gone longest without growing once this much memory is in use, and any chain that reaches an eighth of it divided among the --top chains. DEFAULT VALUE: 256. OPTIONAL." << endl << endl;
+		cout << "        " << "--snapshot-every [integer]" << endl << "        With --stream, print a snapshot after this many words (0 for only at the end). DEFAULT VALUE: 1000000. OPTIONAL." << endl << endl;
+		cout << "        " << "--top [integer]" << endl << "        With --stream, number of longest chains to keep. DEFAULT VALUE: 10. OPTIONAL." << endl << endl;
+		cout << "        " << "--output-format [text/ndjson/binary]" << endl << "        Format of the report: the readable text report, one JSON object per line, or length-prefixed binary records. Ignored with --stream. DEFAULT VALUE: text. OPTIONAL." << endl << endl;
+		cout << "        " << "--save-state [/path/to/state]" << endl << "        After building, save the words and chains to a snapshot file that --load-state can restore. Ignored with --stream. OPTIONAL." << endl << endl;
+		cout << "        " << "--load-state [/path/to/state]" << endl << "        Start from the chains in a snapshot instead of building them. Words from --target-file, if given, are added to the restored chains using the --allow-duplicates, --step-growth and --distance settings stored in the snapshot. Ignored with --stream. OPTIONAL." << endl << endl;
+		cout << "        " << "--merge-chains [true/false]" << endl << "        After building, join chains whose ends are within distance one of each other, reversing a chain where needed, under the same --allow-duplicates, --step-growth and --distance rules. Gives fewer, longer chains. Ignored with --stream. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		cout << "        " << "--min-frequency [integer]" << endl << "        Count every word first, then build chains from each distinct word once, in order of first appearance, leaving out words seen fewer times than this, and report the most frequent words. 0 builds from every word as read. Ignored with --stream. DEFAULT VALUE: 0. OPTIONAL." << endl << endl;
+		cout << "        " << "--neighbors [word]" << endl << "        Instead of the full report, list the words of the input within distance one of this word under --distance, and the chains with an end at one of them, which the word could join. Works on a --load-state snapshot without rebuilding. Ignored with --stream. OPTIONAL." << endl << endl;
+		cout << "        " << "--serve [stdin or /path/to/socket]" << endl << "        After building, answer queries instead of printing the report: one command per line (chains WORD, longest WORD, neighbors WORD, chain NUMBER, stats, quit, shutdown) and one JSON object per reply line, on standard input and output or on a Unix socket at the given path. Ignored with --stream. OPTIONAL." << endl << endl;
+		cout << "        " << "--serve-threads [integer]" << endl << "        With --serve on a socket, number of connections answered at once. DEFAULT VALUE: 4. OPTIONAL." << endl << endl;
+		cout << "        " << "--stats [true/false]" << endl << "        Finish the report with counts of words read and filtered, distance tests, duplicate checks, chains created and merged, deque growths and bytes written, and the time spent loading, reading, building, merging, saving and reporting. Ignored with --stream. DEFAULT VALUE: false. OPTIONAL." << endl << endl;
+		return 1;
+	}
+	
+	// several target files are read through the file pipeline, --target-file first
+	vector<string> batchFiles = splitList(targetFiles, ',');
+	if(targetDir != "" && !listDirectory(targetDir, batchFiles)) {
+		cerr << "The specified target directory " << targetDir << " does not exist or cannot be read. Please try again." << endl;
+		return 1;
+	}
+	if(targetFile != "" && (targetFiles != "" || targetDir != "")) {
+		batchFiles.insert(batchFiles.begin(), targetFile);
+	}
+	
+	// execute program according to command line arguments
+	if(logFile == true){ 
+		cout << "Saving output to file " << "chain_log.txt" << "." << endl; 
+		freopen("chain_log.txt","w",stdout); 
+	}
+	
+	if(stream) { // incremental mode: no full chain listing, memory stays under the limit
+		if(targetFile == "" || targetFiles != "" || targetDir != "") {
+			cerr << "--stream reads a single --target-file (- for standard input) and cannot be combined with --target-files or --target-dir." << endl;
+			return 1;
+		}
+		int fd = (targetFile == "-") ? 0 : open(targetFile.c_str(), O_RDONLY);
+		if(fd < 0) {
+			cerr << "The specified target file " << targetFile << " does not exist or cannot be found. Please try again.";
+			return 1;
+		}
+		
+		ChainStream chainStream(allowDuplicates, stepGrowth, memoryLimit << 20, top, metric);
+		StreamReader reader(fd, filterLength);
+		string_view word;
+		while(reader.next(word)) {
+			chainStream.add(word);
+			if(snapshotEvery != 0 && chainStream.count() % snapshotEvery == 0) {
+				chainStream.snapshot(cout);
+			}
+		}
+		chainStream.snapshot(cout);
+		
+		if(logFile == true){ 
+			fclose(stdout); 
+		}
+		return 0;
+	}
+	
+	ChainBuilder builder(allowDuplicates, stepGrowth, metric);
+	string_view word;
+
+	if(loadState != "") { // start from saved chains instead of an empty set
+		string error;
+		if(!builder.load(loadState, error)) {
+			cerr << "Could not load state: " << error << "." << endl;
+			return 1;
+		}
+		stepGrowth = builder.result().stepGrowth(); // appended words follow the rules the chains were built with
+	}
+	
+	vector<FileThroughput> throughput;
+	double pipelineSeconds = 0;
+	
+	if(!batchFiles.empty()) { // I/O threads read and tokenize the files while this thread builds chains
+		PhaseTimer timer(PHASE_BUILD);
+		FilePipeline pipeline(batchFiles, filterLength, threads);
+		while(pipeline.next(word)) {
+			if(minFrequency > 0) {
+				builder.count(word);
+			} else {
+				builder.add(word);
+			}
+		}
+		throughput = pipeline.throughput();
+		pipelineSeconds = pipeline.seconds();
+		
+		for(std::vector<FileThroughput>::size_type f = 0; f != throughput.size(); f++) {
+			if(!throughput[f].opened) {
+				cerr << "The specified target file " << throughput[f].path << " does not exist or cannot be found. It was skipped." << endl;
+			}
+		}
+	} else if(targetFile != "") {
+		MappedFile input;
+		
+		if(!input.open(targetFile)) { // file could not be opened
+			cerr << "The specified target file " << targetFile << " does not exist or cannot be found. Please try again.";
+			return 1;
+		}
+		
+		if(minFrequency > 0) { // the words are counted here and added once each below
+			builder.countParallel(input.data(), input.size(), filterLength, threads);
+		} else if(threads == 1) {
+			// trimming, the alpha check, the length filter and lowercasing all happen in one pass over the mapped file
+			builder.addText(input.data(), input.size(), filterLength);
+		} else {
+			builder.addParallel(input.data(), input.size(), filterLength, threads, deterministic);
+		}
+		
+		input.close();
+	}
+	
+	if(minFrequency > 0) {
+		builder.addCounted(minFrequency);
+	}
+	
+	if(mergeChainEnds) {
+		builder.merge();
+	}
+	
+	if(saveState != "") {
+		string error;
+		if(!builder.save(saveState, error)) {
+			cerr << "Could not save state: " << error << "." << endl;
+			return 1;
+		}
+	}
+	
+	ChainSet result = builder.finish();
+	const vector<Chain* >& chains = result.chains();
+	const WordPool& pool = result.pool();
+	const ChainStats& stats = result.stats();
+	
+	if(servePath != "") { // query mode: the chains stay in memory and no report is printed
+		ChainServer server(result);
+		if(servePath == "stdin") {
+			server.serve(0, fileno(stdout));
+		} else {
+			cerr << "Serving " << result.size() << " chains on " << servePath << "." << endl;
+			string error;
+			if(!server.listen(servePath, serveThreads, error)) {
+				cerr << "Could not serve on " << servePath << ": " << error << "." << endl;
+				return 1;
+			}
+		}
+		if(logFile == true){ 
+			fclose(stdout); 
+		}
+		return 0;
+	}
+	
+	ReportWriter out(fileno(stdout)); // after any freopen, so it follows --log-file
+	
+	if(neighborsOf != "") { // query mode: one record in place of the report
+		PhaseTimer timer(PHASE_REPORT);
+		vector<uint32_t> found;
+		vector<int> ends;
+		result.neighbors(sw11.str(), found, ends);
+		reportNeighbors(sw11.str(), found, ends, pool, out, outputFormat);
+	} else {
+		PhaseTimer timer(PHASE_REPORT);
+		listAllChains(chains, pool, out, outputFormat); 
+		if(outputFormat == TEXT) { out << "\n\n"; }
+		findLongestChain(chains, stats, pool, out, outputFormat);
+		if(outputFormat == TEXT) { out << "\n\n"; }
+		findLongestWord(chains, stats, pool, out, outputFormat);
+		if(outputFormat == TEXT) { out << "\n\n"; }
+		if(longestPath) {
+			findLongestPath(pool, stepGrowth, threads, searchTime, searchNodes, out, outputFormat);
+			if(outputFormat == TEXT) { out << "\n\n"; }
+		}
+		reportWordPool(pool, result.wordCount(), result.arena(), out, outputFormat);
+		if(outputFormat == TEXT) { out << "\n\n"; }
+		reportStatistics(stats, out, outputFormat);
+		if(minFrequency > 0) {
+			if(outputFormat == TEXT) { out << "\n\n"; }
+			reportFrequency(result.frequencies(), pool, minFrequency, out, outputFormat);
+		}
+		if(!batchFiles.empty()) {
+			if(outputFormat == TEXT) { out << "\n\n"; }
+			reportThroughput(throughput, pipelineSeconds, out, outputFormat);
+		}
+		out.flush();
+	}
+	if(showStats) { // counted up to here, so bytes written covers the report but not this table
+		if(outputFormat == TEXT) { out << "\n\n"; }
+		reportProfile(out, outputFormat);
+	}
+	out.flush();
+	
+	if(logFile == true){ 
+		fclose(stdout); 
+	}
+	
+}
+
+
+      
@@ -0,0 +1,238 @@
+/** 	
+	@name WordGraph.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	The edit-distance-one graph over every distinct word, and searches
+	for the longest word chain it contains.
+ */
+
+#include "WordGraph.h"
+#include "WordTrie.h"
+#include "EditDistance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/**
+	Link every pair of interned words at edit distance one. Neighbors are
+	listed by a trie holding every word, so building the graph costs time
+	proportional to the number of words and edges.
+ */
+WordGraph::WordGraph(const WordPool& pool) {
+   WordTrie trie;
+   for (uint32_t w = 0; w < pool.size(); w++) {
+      trie.insert(pool.str(w), w);
+   }
+
+   offsets.push_back(0);
+   for (uint32_t w = 0; w < pool.size(); w++) {
+      trie.neighbors(pool.str(w), EDIT, targets); // sorted and unique
+      offsets.push_back(targets.size());
+   }
+}
+
+/**
+	Longest chain whose words shrink by one letter at every step, the
+	shape --step-growth builds. Only edges between lengths L and L-1 are
+	used, so the graph is a DAG ordered by length and one dynamic
+	programming pass over the words, shortest first, finds the optimum.
+	The path runs from the longest word to the shortest.
+ */
+PathSearch longestGrowthPath(const WordGraph& graph, const WordPool& pool) {
+   size_t n = graph.vertices();
+   vector<uint32_t> order(n);
+   for (uint32_t w = 0; w < n; w++) { order[w] = w; }
+   stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return pool.length(a) < pool.length(b); });
+
+   vector<uint32_t> best(n, 1);         // words in the longest path starting at w
+   vector<uint32_t> next(n, WordPool::NOT_FOUND);
+   PathSearch result;
+   result.exhaustive = true;
+   result.nodes = 0;
+
+   uint32_t top = WordPool::NOT_FOUND;
+   for (size_t k = 0; k < n; k++) {
+      uint32_t w = order[k];
+      const uint32_t* adjacent = graph.neighbors(w);
+      for (size_t j = 0; j < graph.degree(w); j++) {
+         uint32_t v = adjacent[j];
+         result.nodes++;
+         if (pool.length(v) + 1 == pool.length(w) && best[v] + 1 > best[w]) {
+            best[w] = best[v] + 1;
+            next[w] = v;
+         }
+      }
+      if (top == WordPool::NOT_FOUND || best[w] > best[top]) { top = w; }
+   }
+
+   for (uint32_t w = top; w != WordPool::NOT_FOUND; w = next[w]) {
+      result.path.push_back(w);
+   }
+   return result;
+}
+
+/**
+	Shared state for the branch-and-bound search.
+ */
+struct SimplePathSearch {
+   const WordGraph& graph;
+   vector<uint32_t> starts;          // start words, most promising first
+   vector<uint32_t> componentSize;   // size of the component holding each word
+   atomic<size_t> nextStart;
+   atomic<size_t> bestLength;
+   atomic<uint64_t> nodes;
+   atomic<bool> exhaustive;
+   uint64_t nodeBudget;
+   uint64_t nodesPerStart;
+   chrono::steady_clock::time_point deadline;
+   mutex lock;
+   vector<uint32_t> bestPath;
+
+   explicit SimplePathSearch(const WordGraph& graph)
+    : graph(graph), nextStart(0), bestLength(0), nodes(0), exhaustive(true) { }
+};
+
+/**
+	Record path if it beats the best path found so far.
+ */
+static void offer(SimplePathSearch& search, const vector<uint32_t>& path) {
+   if (path.size() <= search.bestLength.load()) { return; }
+   lock_guard<mutex> guard(search.lock);
+   if (path.size() > search.bestPath.size()) {
+      search.bestPath = path;
+      search.bestLength = path.size();
+   }
+}
+
+/**
+	Depth-first search over simple paths starting at start, trying the
+	neighbors with the fewest onward links first. Stops early when the
+	start's share of the node budget, the global budget or the deadline
+	runs out. Returns whether every path from start was explored.
+ */
+static bool searchFrom(SimplePathSearch& search, uint32_t start, vector<char>& visited) {
+   const WordGraph& graph = search.graph;
+   vector<uint32_t> path(1, start);
+   vector<vector<uint32_t> > choices(1);
+   vector<size_t> cursor(1, 0);
+   uint64_t expanded = 0;
+   bool complete = true;
+
+   visited[start] = 1;
+   choices[0].assign(graph.neighbors(start), graph.neighbors(start) + graph.degree(start));
+   offer(search, path);
+
+   while (!path.empty()) {
+      size_t depth = path.size() - 1;
+      if (cursor[depth] == choices[depth].size()) { // backtrack
+         visited[path.back()] = 0;
+         path.pop_back();
+         continue;
+      }
+      uint32_t v = choices[depth][cursor[depth]++];
+      if (visited[v]) { continue; }
+
+      if (++expanded % 4096 == 0) {
+         search.nodes += 4096;
+         if (expanded >= search.nodesPerStart || search.nodes.load() >= search.nodeBudget
+             || chrono::steady_clock::now() >= search.deadline) {
+            complete = false;
+            break;
+         }
+      }
+
+      visited[v] = 1;
+      path.push_back(v);
+      offer(search, path);
+
+      if (choices.size() <= depth + 1) {
+         choices.resize(depth + 2);
+         cursor.resize(depth + 2);
+      }
+      vector<uint32_t>& options = choices[depth + 1];
+      options.clear();
+      const uint32_t* adjacent = graph.neighbors(v);
+      for (size_t j = 0; j < graph.degree(v); j++) {
+         if (!visited[adjacent[j]]) { options.push_back(adjacent[j]); }
+      }
+      sort(options.begin(), options.end(), [&](uint32_t a, uint32_t b) { return graph.degree(a) < graph.degree(b); });
+      cursor[depth + 1] = 0;
+   }
+
+   for (size_t k = 0; k < path.size(); k++) { visited[path[k]] = 0; }
+   search.nodes += expanded % 4096;
+   return complete;
+}
+
+/**
+	Longest simple path in the graph: the longest chain that never repeats
+	a word. This is NP-hard in general, so it is a branch-and-bound search
+	from every word on threads threads, bounded by a wall-clock deadline
+	and a total node budget. A component no bigger than the best path
+	found so far is skipped, since it cannot hold a longer one. The result
+	is exhaustive only if every start was searched to completion.
+ */
+PathSearch longestSimplePath(const WordGraph& graph, int threads, long milliseconds, uint64_t nodeBudget) {
+   size_t n = graph.vertices();
+   SimplePathSearch search(graph);
+   search.nodeBudget = nodeBudget;
+   search.nodesPerStart = max<uint64_t>(nodeBudget / max<size_t>(n, 1), 4096);
+   search.deadline = chrono::steady_clock::now() + chrono::milliseconds(milliseconds);
+
+   // label connected components
+   vector<uint32_t> component(n, WordPool::NOT_FOUND);
+   vector<uint32_t> stack;
+   for (uint32_t w = 0; w < n; w++) {
+      if (component[w] != WordPool::NOT_FOUND) { continue; }
+      uint32_t label = search.componentSize.size();
+      search.componentSize.push_back(0);
+      component[w] = label;
+      stack.push_back(w);
+      while (!stack.empty()) {
+         uint32_t v = stack.back();
+         stack.pop_back();
+         search.componentSize[label]++;
+         for (size_t j = 0; j < graph.degree(v); j++) {
+            uint32_t u = graph.neighbors(v)[j];
+            if (component[u] == WordPool::NOT_FOUND) {
+               component[u] = label;
+               stack.push_back(u);
+            }
+         }
+      }
+   }
+
+   // big components first, and within them low-degree words, which tend to be path ends
+   search.starts.resize(n);
+   for (uint32_t w = 0; w < n; w++) { search.starts[w] = w; }
+   stable_sort(search.starts.begin(), search.starts.end(), [&](uint32_t a, uint32_t b) {
+      uint32_t ca = search.componentSize[component[a]], cb = search.componentSize[component[b]];
+      return ca != cb ? ca > cb : graph.degree(a) < graph.degree(b);
+   });
+
+   vector<thread> workers;
+   for (int t = 0; t < max(threads, 1); t++) {
+      workers.push_back(thread([&]() {
+         vector<char> visited(n, 0);
+         for (size_t k = search.nextStart++; k < n; k = search.nextStart++) {
+            uint32_t start = search.starts[k];
+            if (search.componentSize[component[start]] <= search.bestLength.load()) { continue; }
+            if (chrono::steady_clock::now() >= search.deadline) {
+               search.exhaustive = false;
+               break;
+            }
+            if (!searchFrom(search, start, visited)) { search.exhaustive = false; }
+         }
+      }));
+   }
+   for (size_t t = 0; t < workers.size(); t++) { workers[t].join(); }
+
+   PathSearch result;
+   result.path = search.bestPath;
+   result.exhaustive = search.exhaustive.load();
+   result.nodes = search.nodes.load();
+   return result;
+}
@@ -0,0 +1,45 @@
+/** 	
+	@name WordGraph.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	The edit-distance-one graph over every distinct word, and searches
+	for the longest word chain it contains.
+ */
+
+#ifndef WORDGRAPH_H_
+#define WORDGRAPH_H_
+
+#include "WordPool.h"
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+class WordGraph {
+   vector<uint32_t> offsets;  // neighbors of word w are targets[offsets[w] .. offsets[w+1])
+   vector<uint32_t> targets;
+
+ public:
+   explicit WordGraph(const WordPool& pool);
+
+   size_t vertices() const { return offsets.size() - 1; }
+   size_t edges() const { return targets.size() / 2; }
+   size_t degree(uint32_t w) const { return offsets[w + 1] - offsets[w]; }
+   const uint32_t* neighbors(uint32_t w) const { return targets.data() + offsets[w]; }
+};
+
+/**
+	Result of a longest path search. exhaustive is true when the search
+	finished inside its budget, so path is a true longest path.
+ */
+struct PathSearch {
+   vector<uint32_t> path;
+   bool exhaustive;
+   uint64_t nodes;
+};
+
+PathSearch longestGrowthPath(const WordGraph& graph, const WordPool& pool);
+PathSearch longestSimplePath(const WordGraph& graph, int threads, long milliseconds, uint64_t nodeBudget);
+
+#endif
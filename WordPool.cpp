@@ -0,0 +1,105 @@
+/** 	
+	@name WordPool.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Word interning over a single character arena.
+ */
+
+#include "WordPool.h"
+#include <utility>
+
+const uint32_t WordPool::NOT_FOUND;
+
+WordPool::WordPool() : offsets(1, 0), table(1024, NOT_FOUND) { }
+
+/**
+	FNV-1a hash of a word.
+ */
+uint32_t WordPool::hash(string_view word) {
+   uint32_t h = 2166136261u;
+   for (size_t i = 0; i < word.size(); i++) {
+      h = (h ^ (unsigned char)word[i]) * 16777619u;
+   }
+   return h;
+}
+
+/**
+	Return the table slot holding word, or the empty slot where it
+	would go.
+ */
+uint32_t WordPool::slotOf(string_view word, uint32_t h) const {
+   uint32_t mask = table.size() - 1;
+   for (uint32_t k = h & mask; ; k = (k + 1) & mask) {
+      uint32_t id = table[k];
+      if (id == NOT_FOUND || (hashes[id] == h && str(id) == word)) { return k; }
+   }
+}
+
+/**
+	Return the id of word, copying it into the arena if it is new.
+ */
+uint32_t WordPool::intern(string_view word) {
+   uint32_t h = hash(word);
+   uint32_t k = slotOf(word, h);
+   if (table[k] != NOT_FOUND) { return table[k]; }
+
+   uint32_t id = hashes.size();
+   chars.insert(chars.end(), word.begin(), word.end());
+   chars.push_back('\0');
+   offsets.push_back(chars.size());
+   hashes.push_back(h);
+   table[k] = id;
+
+   if (2 * hashes.size() > table.size()) { grow(); }
+   return id;
+}
+
+/**
+	Return the id of word, or NOT_FOUND if it has never been interned.
+ */
+uint32_t WordPool::find(string_view word) const {
+   return table[slotOf(word, hash(word))];
+}
+
+/**
+	Double the table and re-insert every id.
+ */
+void WordPool::grow() {
+   table.assign(2 * table.size(), NOT_FOUND);
+   uint32_t mask = table.size() - 1;
+   for (uint32_t id = 0; id < hashes.size(); id++) {
+      uint32_t k = hashes[id] & mask;
+      while (table[k] != NOT_FOUND) { k = (k + 1) & mask; }
+      table[k] = id;
+   }
+}
+
+/**
+	Bytes of heap held by the pool.
+ */
+size_t WordPool::bytes() const {
+   return chars.capacity() * sizeof(char)
+        + (offsets.capacity() + hashes.capacity() + table.capacity()) * sizeof(uint32_t);
+}
+
+/**
+	Expose the arena, offsets, hashes and table as raw arrays.
+ */
+WordPoolArrays WordPool::arrays() const {
+   WordPoolArrays a = { chars.data(), chars.size(), offsets.data(), hashes.data(), hashes.size(), table.data(), table.size() };
+   return a;
+}
+
+/**
+	Replace the pool with arrays laid out as arrays() exposes them, such
+	as those read back from a snapshot, taking over their buffers rather
+	than copying them or re-hashing any word. The caller must have
+	checked that they form a valid pool.
+ */
+void WordPool::adopt(vector<char>&& arena, vector<uint32_t>&& starts, vector<uint32_t>&& wordHashes, vector<uint32_t>&& slots) {
+   chars = move(arena);
+   offsets = move(starts);
+   hashes = move(wordHashes);
+   table = move(slots);
+}
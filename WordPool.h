@@ -0,0 +1,71 @@
+/** 	
+	@name WordPool.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Word interning. Every distinct word is stored once in a single
+	character arena and named by a dense 32-bit id, so chains can hold
+	ids and compare words with integer compares.
+ */
+
+#ifndef WORDPOOL_H_
+#define WORDPOOL_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+	The raw arrays behind a WordPool, for writing it out.
+ */
+struct WordPoolArrays {
+   const char* chars;
+   size_t charBytes;
+   const uint32_t* offsets;   // words + 1 entries
+   const uint32_t* hashes;    // words entries
+   size_t words;
+   const uint32_t* table;
+   size_t tableSize;
+};
+
+class WordPool {
+   vector<char> chars;        // every word once, each followed by '\0'
+   vector<uint32_t> offsets;  // word id starts at chars[offsets[id]]; one extra entry marks the end
+   vector<uint32_t> hashes;   // hash of each word, checked before comparing characters
+   vector<uint32_t> table;    // open-addressing table of ids; size is a power of two
+
+   uint32_t slotOf(string_view word, uint32_t h) const;
+   void grow();
+
+ public:
+   static const uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+   static uint32_t hash(string_view word);  // what hashes[] holds; public so a loaded snapshot can be checked
+
+   WordPool();
+
+   uint32_t intern(string_view word);
+   uint32_t find(string_view word) const;
+
+	/**
+		Return the word with the given id. The view is only valid until
+		the next call to intern().
+	*/
+   string_view str(uint32_t id) const { return string_view(&chars[offsets[id]], length(id)); }
+
+	/**
+		Return the length of the word with the given id.
+	*/
+   size_t length(uint32_t id) const { return offsets[id + 1] - offsets[id] - 1; }
+
+   size_t size() const { return hashes.size(); }
+   size_t bytes() const;
+
+   WordPoolArrays arrays() const;
+   void adopt(vector<char>&& arena, vector<uint32_t>&& starts, vector<uint32_t>&& wordHashes, vector<uint32_t>&& slots);
+};
+
+#endif
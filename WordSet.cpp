@@ -0,0 +1,58 @@
+/** 	
+	@name WordSet.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Open-addressing (linear probing) hash set of word ids.
+ */
+
+#include "WordSet.h"
+
+const uint32_t WordSet::EMPTY;
+
+/**
+	Determines whether id is in the set.
+ */
+bool WordSet::contains(uint32_t id) const {
+   if (slots.empty()) { return false; }
+
+   uint32_t mask = slots.size() - 1;
+   for (uint32_t k = slotFor(id, shift); ; k = (k + 1) & mask) {
+      if (slots[k] == id) { return true; }
+      if (slots[k] == EMPTY) { return false; }
+   }
+}
+
+/**
+	Add id to the set. Inserting an id twice has no effect.
+ */
+void WordSet::insert(uint32_t id) {
+   if (2 * (count + 1) > slots.size()) { grow(); }
+
+   uint32_t mask = slots.size() - 1;
+   uint32_t k = slotFor(id, shift);
+   while (slots[k] != EMPTY) {
+      if (slots[k] == id) { return; }
+      k = (k + 1) & mask;
+   }
+   slots[k] = id;
+   count++;
+}
+
+/**
+	Double the table (starting at 8 slots) and rehash every id.
+ */
+void WordSet::grow() {
+   vector<uint32_t> old;
+   old.swap(slots);
+   slots.assign(old.empty() ? 8 : 2 * old.size(), EMPTY);
+   shift = old.empty() ? 29 : shift - 1;
+
+   uint32_t mask = slots.size() - 1;
+   for (size_t i = 0; i < old.size(); i++) {
+      if (old[i] == EMPTY) { continue; }
+      uint32_t k = slotFor(old[i], shift);
+      while (slots[k] != EMPTY) { k = (k + 1) & mask; }
+      slots[k] = old[i];
+   }
+}
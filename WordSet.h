@@ -0,0 +1,41 @@
+/** 	
+	@name WordSet.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Open-addressing hash set of word ids. Lookups never allocate; the
+	table is only allocated on the first insert and doubles whenever it
+	becomes half full, so membership tests cost O(1) whatever the size.
+ */
+
+#ifndef WORDSET_H_
+#define WORDSET_H_
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+class WordSet {
+   vector<uint32_t> slots; // EMPTY or a word id; size is zero or a power of two
+   uint32_t count;
+   uint32_t shift;         // 32 - log2(slots.size()), so a hash shifted right by it is a slot
+
+   static const uint32_t EMPTY = 0xFFFFFFFF;
+
+	/**
+		Fibonacci hashing: the high bits of the product mix every bit of
+		the id, where the low bits would leave sequential ids clustered.
+	*/
+   static uint32_t slotFor(uint32_t id, uint32_t shift) { return (id * 0x9e3779b1u) >> shift; }
+   void grow();
+
+ public:
+   WordSet() : count(0), shift(32) { }
+
+   bool contains(uint32_t id) const;
+   void insert(uint32_t id);
+   size_t size() const { return count; }
+};
+
+#endif
@@ -0,0 +1,164 @@
+/** 	
+	@name WordTrie.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Trie over a vocabulary of lowercase words, with neighbor enumeration
+	for one edit.
+ */
+
+#include "WordTrie.h"
+#include <algorithm>
+
+const uint32_t WordTrie::NOT_FOUND;
+
+WordTrie::WordTrie() : freeBlocks(27), words(0) {
+   childMask.push_back(0); // the root, for the empty prefix
+   childBase.push_back(0);
+   wordId.push_back(NOT_FOUND);
+}
+
+/**
+	Determines whether word is made only of the letters a-z, as every
+	word in the trie must be.
+ */
+bool WordTrie::isWord(string_view word) {
+   for (size_t i = 0; i < word.size(); i++) {
+      if (word[i] < 'a' || word[i] > 'z') { return false; }
+   }
+   return !word.empty();
+}
+
+/**
+	Child of node for letter (0-25), or NOT_FOUND.
+ */
+inline uint32_t WordTrie::child(uint32_t node, uint32_t letter) const {
+   uint32_t mask = childMask[node];
+   uint32_t bit = 1u << letter;
+   if (!(mask & bit)) { return NOT_FOUND; }
+   return children[childBase[node] + __builtin_popcount(mask & (bit - 1))];
+}
+
+/**
+	Give node a new child for letter. The node's block is copied into one
+	a slot larger, taken from the free blocks of that size when there is
+	one, and the old block is kept for reuse.
+ */
+uint32_t WordTrie::addChild(uint32_t node, uint32_t letter) {
+   uint32_t created = childMask.size();
+   childMask.push_back(0);
+   childBase.push_back(0);
+   wordId.push_back(NOT_FOUND);
+
+   uint32_t mask = childMask[node];
+   uint32_t count = __builtin_popcount(mask);
+   uint32_t rank = __builtin_popcount(mask & ((1u << letter) - 1));
+   uint32_t base;
+   if (!freeBlocks[count + 1].empty()) {
+      base = freeBlocks[count + 1].back();
+      freeBlocks[count + 1].pop_back();
+   } else {
+      base = children.size();
+      children.resize(children.size() + count + 1);
+   }
+
+   uint32_t old = childBase[node];
+   for (uint32_t k = 0; k < rank; k++) { children[base + k] = children[old + k]; }
+   children[base + rank] = created;
+   for (uint32_t k = rank; k < count; k++) { children[base + k + 1] = children[old + k]; }
+   if (count > 0) { freeBlocks[count].push_back(old); }
+
+   childBase[node] = base;
+   childMask[node] = mask | (1u << letter);
+   return created;
+}
+
+/**
+	Add word with the given id. Returns false, leaving the trie as it
+	was, if the word is already there or is not made of a-z.
+ */
+bool WordTrie::insert(string_view word, uint32_t id) {
+   if (!isWord(word)) { return false; }
+   uint32_t node = 0;
+   for (size_t i = 0; i < word.size(); i++) {
+      uint32_t letter = word[i] - 'a';
+      uint32_t next = child(node, letter);
+      node = (next == NOT_FOUND) ? addChild(node, letter) : next;
+   }
+   if (wordId[node] != NOT_FOUND) { return false; }
+   wordId[node] = id;
+   words++;
+   return true;
+}
+
+/**
+	Id of the word reached by reading rest from node, or NOT_FOUND.
+ */
+inline uint32_t WordTrie::follow(uint32_t node, string_view rest) const {
+   for (size_t i = 0; i < rest.size() && node != NOT_FOUND; i++) {
+      uint32_t letter = rest[i] - 'a';
+      if (letter >= 26) { return NOT_FOUND; }
+      node = child(node, letter);
+   }
+   return (node == NOT_FOUND) ? NOT_FOUND : wordId[node];
+}
+
+/**
+	Id of word, or NOT_FOUND.
+ */
+uint32_t WordTrie::find(string_view word) const {
+   return follow(0, word);
+}
+
+/**
+	Append the id of every word at distance one from word under metric,
+	each once: substitutions only for HAMMING, plus a letter added or
+	removed at either end for EXTENSION, or anywhere for EDIT. word
+	itself is never reported. lengths limits the neighbors to those
+	shorter, as long as or longer than word.
+ */
+void WordTrie::neighbors(string_view word, Metric metric, vector<uint32_t>& out, unsigned lengths) const {
+   size_t first = out.size();
+   size_t n = word.size();
+   uint32_t node = 0; // reached by word[0, i)
+   for (size_t i = 0; i <= n && node != NOT_FOUND; i++) {
+      bool anywhere = (metric == EDIT) || (metric == EXTENSION && (i == 0 || i == n));
+      uint32_t mask = childMask[node];
+      uint32_t base = childBase[node];
+
+      if (anywhere && (lengths & LONGER)) { // insert a letter before word[i]
+         for (uint32_t k = 0, m = mask; m != 0; k++, m &= m - 1) {
+            uint32_t id = follow(children[base + k], word.substr(i));
+            if (id != NOT_FOUND) { out.push_back(id); }
+         }
+      }
+      if (i == n) { break; }
+
+      uint32_t letter = word[i] - 'a';
+      bool endDelete = (metric == EXTENSION && (i == 0 || i == n - 1));
+      if ((metric == EDIT || endDelete) && (lengths & SHORTER)) { // remove word[i]
+         uint32_t id = follow(node, word.substr(i + 1));
+         if (id != NOT_FOUND) { out.push_back(id); }
+      }
+      for (uint32_t k = 0, m = (lengths & SAME_LENGTH) ? mask : 0; m != 0; k++, m &= m - 1) { // replace word[i]
+         if ((uint32_t)__builtin_ctz(m) == letter) { continue; }
+         uint32_t id = follow(children[base + k], word.substr(i + 1));
+         if (id != NOT_FOUND) { out.push_back(id); }
+      }
+
+      node = (letter < 26) ? child(node, letter) : NOT_FOUND;
+   }
+
+   // a run of equal letters reaches the same word from several positions
+   sort(out.begin() + first, out.end());
+   out.erase(unique(out.begin() + first, out.end()), out.end());
+}
+
+/**
+	Memory held by the node arrays and child blocks.
+ */
+size_t WordTrie::bytes() const {
+   size_t total = (childMask.capacity() + childBase.capacity() + wordId.capacity() + children.capacity()) * sizeof(uint32_t);
+   for (size_t k = 0; k < freeBlocks.size(); k++) { total += freeBlocks[k].capacity() * sizeof(uint32_t); }
+   return total;
+}
@@ -0,0 +1,61 @@
+/** 	
+	@name WordTrie.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Trie over a vocabulary of lowercase words, kept in flat arrays. Each
+	node stores a 26-bit mask of the letters it has children for and the
+	start of a block holding those children in letter order, so a child
+	is found with one popcount and nodes cost 12 bytes plus 4 per edge.
+	
+	neighbors() walks the trie like a Levenshtein automaton for one edit:
+	it follows the word's own path and, at each position, spends its one
+	edit on a substitution, insertion or deletion before matching the
+	rest of the word exactly. Every word at distance one is found in time
+	that depends on the word's length and the branching along its path,
+	never on the size of the vocabulary. Each kind of edit gives
+	neighbors of one length, so asking for only shorter or longer
+	neighbors skips the substitutions altogether.
+ */
+
+#ifndef WORDTRIE_H_
+#define WORDTRIE_H_
+
+#include "EditDistance.h"
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+class WordTrie {
+   vector<uint32_t> childMask;    // by node: bit c set when there is a child for letter 'a' + c
+   vector<uint32_t> childBase;    // by node: first slot of its block in children
+   vector<uint32_t> wordId;       // by node: id of the word ending here, or NOT_FOUND
+   vector<uint32_t> children;     // child node ids, one block per node
+   vector<vector<uint32_t> > freeBlocks; // blocks given up when a node outgrew them, by size
+   size_t words;
+
+   uint32_t child(uint32_t node, uint32_t letter) const;
+   uint32_t addChild(uint32_t node, uint32_t letter);
+   uint32_t follow(uint32_t node, string_view rest) const;
+
+ public:
+   static const uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+   // neighbor lengths, relative to the word
+   enum { SHORTER = 1, SAME_LENGTH = 2, LONGER = 4, ANY_LENGTH = 7 };
+
+   WordTrie();
+
+   bool insert(string_view word, uint32_t id);
+   uint32_t find(string_view word) const;
+   void neighbors(string_view word, Metric metric, vector<uint32_t>& out, unsigned lengths = ANY_LENGTH) const;
+
+   size_t size() const { return words; }
+   size_t bytes() const;
+
+   static bool isWord(string_view word);
+};
+
+#endif
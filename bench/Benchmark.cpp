@@ -0,0 +1,321 @@
+/**
+	@name Benchmark.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+
+	Micro-benchmarks for the hot paths (distance tests, duplicate checks,
+	chain building, tokenization, neighbor screening), heap use of chain storage with and
+	without the chain arena, and an end-to-end run of the
+	WordChainGenerator binary, all over a synthetic corpus. Results are
+	printed as a table and written as JSON so runs can be compared.
+ */
+
+#include "SyntheticCorpus.h"
+#include "ChainBuilder.h"
+#include "EditDistance.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace std::chrono;
+
+struct Measurement {
+   string name;
+   uint64_t operations;
+   double seconds;
+};
+
+static volatile uint64_t sink; // keeps results alive so loops are not optimized away
+static atomic<uint64_t> allocations(0); // calls to operator new, replaced below
+
+void* operator new(size_t size) {
+   allocations.fetch_add(1, memory_order_relaxed);
+   void* p = malloc(size ? size : 1);
+   if (p == NULL) { throw bad_alloc(); }
+   return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct MemoryMeasurement {
+   string name;
+   uint64_t allocations;
+   long residentKb;       // growth of resident memory while the chains are alive
+   double seconds;
+};
+
+/**
+	Current resident set size in KB, from /proc/self/statm.
+ */
+static long residentKb() {
+   long pages = 0, resident = 0;
+   FILE* statm = fopen("/proc/self/statm", "r");
+   if (statm == NULL) { return 0; }
+   if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) { resident = 0; }
+   fclose(statm);
+   return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+template <typename Work>
+static Measurement measure(const string& name, uint64_t operations, Work work) {
+   steady_clock::time_point start = steady_clock::now();
+   work();
+   Measurement m = { name, operations, duration<double>(steady_clock::now() - start).count() };
+   return m;
+}
+
+/**
+	Pairs of vocabulary words, half of them one random edit apart and
+	half unrelated, so the distance tests see both outcomes.
+ */
+static vector<pair<string, string> > makePairs(const vector<string>& words, size_t count, unsigned seed) {
+   mt19937 random(seed);
+   vector<pair<string, string> > pairs;
+   for (size_t k = 0; k < count && !words.empty(); k++) {
+      string a = words[random() % words.size()];
+      string b;
+      if (k % 2 == 0) {
+         b = a;
+         size_t at = random() % (b.size() + 1);
+         switch (random() % 3) {
+            case 0: if (at < b.size()) { b[at] = 'a' + random() % 26; } break;
+            case 1: b.insert(b.begin() + at, (char)('a' + random() % 26)); break;
+            case 2: if (at < b.size() && b.size() > 1) { b.erase(at, 1); } break;
+         }
+      } else {
+         b = words[random() % words.size()];
+      }
+      pairs.push_back(make_pair(a, b));
+   }
+   return pairs;
+}
+
+template <bool (*Test)(string_view, string_view)>
+static Measurement distanceBenchmark(const string& name, const vector<pair<string, string> >& pairs, int rounds) {
+   return measure(name, (uint64_t)pairs.size() * rounds, [&]() {
+      uint64_t hits = 0;
+      for (int r = 0; r < rounds; r++) {
+         for (size_t k = 0; k < pairs.size(); k++) { hits += Test(pairs[k].first, pairs[k].second); }
+      }
+      sink = hits;
+   });
+}
+
+/**
+	Run the real binary over path and report its wall time, peak RSS and
+	the number of chains it listed.
+ */
+static bool endToEnd(const string& binary, const string& path, double& seconds, long& peakKb, uint64_t& chains) {
+   int out[2];
+   if (pipe(out) != 0) { return false; }
+
+   steady_clock::time_point start = steady_clock::now();
+   pid_t child = fork();
+   if (child == 0) {
+      dup2(out[1], 1);
+      close(out[0]);
+      close(out[1]);
+      execl(binary.c_str(), binary.c_str(), "--target-file", path.c_str(), (char*)NULL);
+      _exit(127);
+   }
+   close(out[1]);
+
+   FILE* report = fdopen(out[0], "r");
+   char* line = NULL;
+   size_t capacity = 0;
+   chains = 0;
+   while (getline(&line, &capacity, report) != -1) {
+      if (string(line).compare(0, 7, "Chain #") == 0) { chains++; }
+   }
+   free(line);
+   fclose(report);
+
+   int status;
+   struct rusage usage;
+   wait4(child, &status, 0, &usage);
+   seconds = duration<double>(steady_clock::now() - start).count();
+   peakKb = usage.ru_maxrss;
+   return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char* argv[]) {
+   CorpusSpec spec;
+   string json = "bench_results.json";
+   string binary = "./WordChainGenerator";
+   int rounds = 20;
+
+   for (int i = 1; i < argc; i++) {
+      string option(argv[i]);
+      if (parseCorpusOption(argc, argv, i, spec)) { continue; }
+      if (option == "--json" && i + 1 < argc) { json = argv[++i]; continue; }
+      if (option == "--binary" && i + 1 < argc) { binary = argv[++i]; continue; }
+      if (option == "--rounds" && i + 1 < argc) { rounds = atoi(argv[++i]); continue; }
+
+      cerr << "Usage:" << argv[0] << " [OPTIONS]" << endl;
+      printCorpusOptions(cerr);
+      cerr << "        --json [/path/to/results.json] DEFAULT VALUE: bench_results.json" << endl;
+      cerr << "        --binary [/path/to/WordChainGenerator] DEFAULT VALUE: ./WordChainGenerator" << endl;
+      cerr << "        --rounds [integer]            repetitions of the distance benchmarks. DEFAULT VALUE: 20" << endl;
+      return 1;
+   }
+
+   string text = makeCorpus(spec);
+   vector<Measurement> results;
+
+   // distance tests
+   vector<pair<string, string> > pairs = makePairs(makeVocabulary(spec), 100000, spec.seed);
+   results.push_back(distanceBenchmark<hd1>("hd1", pairs, rounds));
+   results.push_back(distanceBenchmark<xd1>("xd1", pairs, rounds));
+   results.push_back(distanceBenchmark<ed1>("ed1", pairs, rounds));
+
+   // tokenization
+   WordPool pool;
+   vector<uint32_t> words;
+   results.push_back(measure("tokenize", spec.tokens, [&]() {
+      Tokenizer tokens(text.data(), text.size(), 0);
+      string_view word;
+      uint64_t letters = 0;
+      while (tokens.next(word)) { letters += word.size(); }
+      sink = letters;
+   }));
+   {
+      Tokenizer tokens(text.data(), text.size(), 0);
+      string_view word;
+      while (tokens.next(word)) { words.push_back(pool.intern(word)); }
+   }
+
+   // chain building without and with duplicates, then again with chains in the arena;
+   // allocations and resident growth are counted while each set of chains is alive,
+   // after the first pass has already grown the heap once
+   uint64_t chainCount = 0;
+   vector<MemoryMeasurement> memory;
+   const char* names[3] = { "testNewWord (no duplicates)", "testNewWord", "testNewWord (arena)" };
+   for (int pass = 0; pass < 3; pass++) {
+      bool allowDuplicate = pass != 0;
+      bool stepGrowth = false;
+      ChainArena* arena = (pass == 2) ? new ChainArena() : NULL;
+      vector<Chain* > chains;
+      EndpointIndex index;
+      uint64_t before = allocations.load();
+      long rssBefore = residentKb();
+      Measurement m = measure(names[pass], words.size(), [&]() {
+         for (size_t k = 0; k < words.size(); k++) {
+            testNewWord(words[k], chains, index, pool, allowDuplicate, stepGrowth, NULL, arena);
+         }
+      });
+      results.push_back(m);
+      if (pass != 0) {
+         MemoryMeasurement entry = { arena ? "chains in arena" : "chains on heap", allocations.load() - before, residentKb() - rssBefore, m.seconds };
+         memory.push_back(entry);
+      }
+      if (pass == 1) { chainCount = chains.size(); }
+      if (arena) { delete arena; } else { for (size_t i = 0; i < chains.size(); i++) { delete chains[i]; } }
+   }
+
+   // duplicate checks against one long chain
+   {
+      vector<Chain* > chains(1, new Chain(&pool, true));
+      for (size_t k = 0; k < words.size() && chains[0]->size() < 10000; k++) {
+         if (!chains[0]->contains(words[k])) { chains[0]->pushRear(words[k]); }
+      }
+      uint64_t checks = (uint64_t)words.size() * rounds;
+      results.push_back(measure("checkDuplicate", checks, [&]() {
+         uint64_t hits = 0;
+         for (int r = 0; r < rounds; r++) {
+            for (size_t k = 0; k < words.size(); k++) { hits += checkDuplicate(words[k], 0, chains); }
+         }
+         sink = hits;
+      }));
+      delete chains[0];
+   }
+
+   // one word against the whole vocabulary, as --neighbors asks: the
+   // bit-parallel pattern over the packed pool, then ed1() per word
+   {
+      WordPoolArrays packed = pool.arrays();
+      size_t queries = min<size_t>(words.size(), 200);
+      vector<uint32_t> found;
+      results.push_back(measure("EditPattern::screen", (uint64_t)queries * packed.words, [&]() {
+         for (size_t q = 0; q < queries; q++) {
+            EditPattern pattern(pool.str(words[q]));
+            pattern.screen(packed.chars, packed.offsets, packed.words, found);
+         }
+         sink = found.size();
+      }));
+      results.push_back(measure("ed1 over vocabulary", (uint64_t)queries * packed.words, [&]() {
+         uint64_t hits = 0;
+         for (size_t q = 0; q < queries; q++) {
+            string_view word = pool.str(words[q]);
+            for (uint32_t id = 0; id < pool.size(); id++) { hits += ed1(word, pool.str(id)); }
+         }
+         sink = hits;
+      }));
+   }
+
+   // end to end through the real binary
+   char path[] = "/tmp/wordchain-bench-XXXXXX";
+   int fd = mkstemp(path);
+   bool ran = false;
+   double seconds = 0;
+   long peakKb = 0;
+   uint64_t listed = 0;
+   if (fd >= 0) {
+      ssize_t written = write(fd, text.data(), text.size());
+      close(fd);
+      ran = written == (ssize_t)text.size() && endToEnd(binary, path, seconds, peakKb, listed);
+      unlink(path);
+   }
+
+   // report
+   printf("%-30s %14s %12s %14s\n", "benchmark", "operations", "seconds", "ns/op");
+   for (size_t k = 0; k < results.size(); k++) {
+      printf("%-30s %14llu %12.4f %14.2f\n", results[k].name.c_str(), (unsigned long long)results[k].operations,
+             results[k].seconds, 1e9 * results[k].seconds / max<uint64_t>(results[k].operations, 1));
+   }
+   for (size_t k = 0; k < memory.size(); k++) {
+      printf("%-30s %14llu allocations, resident +%ld KB, %.4f s\n", memory[k].name.c_str(),
+             (unsigned long long)memory[k].allocations, memory[k].residentKb, memory[k].seconds);
+   }
+   if (ran) {
+      printf("end to end: %zu words in %.3f s (%.0f words/sec), peak RSS %ld KB, %llu chains\n",
+             words.size(), seconds, words.size() / seconds, peakKb, (unsigned long long)listed);
+   } else {
+      printf("end to end: could not run %s\n", binary.c_str());
+   }
+
+   ofstream out(json.c_str());
+   out << "{\n  \"corpus\": ";
+   writeCorpusSpec(out, spec);
+   out << ",\n  \"kernel\": \"" << editDistanceKernel() << "\",\n  \"unique_words\": " << pool.size()
+       << ",\n  \"chains\": " << chainCount << ",\n  \"micro\": [\n";
+   for (size_t k = 0; k < results.size(); k++) {
+      out << "    {\"name\": \"" << results[k].name << "\", \"operations\": " << results[k].operations
+          << ", \"seconds\": " << results[k].seconds
+          << ", \"ns_per_op\": " << 1e9 * results[k].seconds / max<uint64_t>(results[k].operations, 1) << "}"
+          << (k + 1 < results.size() ? "," : "") << "\n";
+   }
+   out << "  ],\n  \"memory\": [\n";
+   for (size_t k = 0; k < memory.size(); k++) {
+      out << "    {\"name\": \"" << memory[k].name << "\", \"allocations\": " << memory[k].allocations
+          << ", \"resident_kb\": " << memory[k].residentKb << ", \"seconds\": " << memory[k].seconds << "}"
+          << (k + 1 < memory.size() ? "," : "") << "\n";
+   }
+   out << "  ],\n  \"end_to_end\": ";
+   if (ran) {
+      out << "{\"words\": " << words.size() << ", \"seconds\": " << seconds
+          << ", \"words_per_sec\": " << words.size() / seconds << ", \"peak_rss_kb\": " << peakKb
+          << ", \"chains\": " << listed << "}";
+   } else {
+      out << "null";
+   }
+   out << "\n}\n";
+   return ran ? 0 : 1;
+}
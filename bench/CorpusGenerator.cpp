@@ -0,0 +1,24 @@
+/** 	
+	@name CorpusGenerator.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Writes a reproducible synthetic corpus to standard output, for use
+	as a --target-file.
+ */
+
+#include "SyntheticCorpus.h"
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+   CorpusSpec spec;
+   for (int i = 1; i < argc; i++) {
+      if (!parseCorpusOption(argc, argv, i, spec)) {
+         cerr << "Usage:" << argv[0] << " [OPTIONS] > corpus.txt" << endl;
+         printCorpusOptions(cerr);
+         return 1;
+      }
+   }
+   cout << makeCorpus(spec);
+   return 0;
+}
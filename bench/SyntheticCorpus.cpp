@@ -0,0 +1,133 @@
+/** 	
+	@name SyntheticCorpus.cpp
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Reproducible synthetic text for benchmarks.
+ */
+
+#include "SyntheticCorpus.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdlib.h>
+#include <unordered_set>
+
+CorpusSpec::CorpusSpec()
+ : vocabulary(20000), tokens(200000), meanLength(5.0), maxLength(20),
+   neighborDensity(0.5), zipf(1.0), noise(0.05), seed(250) { }
+
+/**
+	Consume argv[i] (and its value) if it is a corpus option. Returns
+	false if it is not one.
+ */
+bool parseCorpusOption(int argc, char* argv[], int& i, CorpusSpec& spec) {
+   string option(argv[i]);
+   if (i + 1 >= argc) { return false; }
+
+   if (option == "--vocabulary")            { spec.vocabulary = strtoull(argv[++i], NULL, 10); }
+   else if (option == "--tokens")           { spec.tokens = strtoull(argv[++i], NULL, 10); }
+   else if (option == "--mean-length")      { spec.meanLength = atof(argv[++i]); }
+   else if (option == "--max-length")       { spec.maxLength = atoi(argv[++i]); }
+   else if (option == "--neighbor-density") { spec.neighborDensity = atof(argv[++i]); }
+   else if (option == "--zipf")             { spec.zipf = atof(argv[++i]); }
+   else if (option == "--noise")            { spec.noise = atof(argv[++i]); }
+   else if (option == "--seed")             { spec.seed = strtoul(argv[++i], NULL, 10); }
+   else { return false; }
+   return true;
+}
+
+void printCorpusOptions(ostream& out) {
+   CorpusSpec d;
+   out << "        --vocabulary [integer]        distinct words. DEFAULT VALUE: " << d.vocabulary << endl;
+   out << "        --tokens [integer]            words in the corpus. DEFAULT VALUE: " << d.tokens << endl;
+   out << "        --mean-length [number]        mean word length. DEFAULT VALUE: " << d.meanLength << endl;
+   out << "        --max-length [integer]        longest word. DEFAULT VALUE: " << d.maxLength << endl;
+   out << "        --neighbor-density [0..1]     chance a new word is one edit from an earlier word. DEFAULT VALUE: " << d.neighborDensity << endl;
+   out << "        --zipf [number]               word frequency exponent. DEFAULT VALUE: " << d.zipf << endl;
+   out << "        --noise [0..1]                chance a token is capitalized or punctuated. DEFAULT VALUE: " << d.noise << endl;
+   out << "        --seed [integer]              random seed. DEFAULT VALUE: " << d.seed << endl;
+}
+
+/**
+	Write spec as a JSON object.
+ */
+void writeCorpusSpec(ostream& out, const CorpusSpec& spec) {
+   out << "{\"vocabulary\": " << spec.vocabulary << ", \"tokens\": " << spec.tokens
+       << ", \"mean_length\": " << spec.meanLength << ", \"max_length\": " << spec.maxLength
+       << ", \"neighbor_density\": " << spec.neighborDensity << ", \"zipf\": " << spec.zipf
+       << ", \"noise\": " << spec.noise << ", \"seed\": " << spec.seed << "}";
+}
+
+static char randomLetter(mt19937& random) {
+   return 'a' + random() % 26;
+}
+
+/**
+	Build the vocabulary. A word picked for mutation gets one random
+	substitution, insertion or deletion; if the result is a repeat or
+	out of the length range a fresh random word is used instead.
+ */
+vector<string> makeVocabulary(const CorpusSpec& spec) {
+   mt19937 random(spec.seed);
+   poisson_distribution<int> extraLength(max(spec.meanLength - 1.0, 0.0));
+   uniform_real_distribution<double> unit(0.0, 1.0);
+   vector<string> words;
+   unordered_set<string> seen;
+
+   while (words.size() < spec.vocabulary) {
+      string word;
+      if (!words.empty() && unit(random) < spec.neighborDensity) {
+         word = words[random() % words.size()];
+         size_t at = random() % (word.size() + 1);
+         switch (random() % 3) {
+            case 0: if (at < word.size()) { word[at] = randomLetter(random); } break;
+            case 1: word.insert(word.begin() + at, randomLetter(random)); break;
+            case 2: if (at < word.size()) { word.erase(at, 1); } break;
+         }
+      }
+      if (word.empty() || (int)word.size() > spec.maxLength || seen.count(word)) {
+         int length = min(1 + extraLength(random), spec.maxLength);
+         word.clear();
+         for (int k = 0; k < length; k++) { word += randomLetter(random); }
+         if (seen.count(word)) { continue; }
+      }
+      seen.insert(word);
+      words.push_back(word);
+   }
+   shuffle(words.begin(), words.end(), random); // frequency rank independent of creation order
+   return words;
+}
+
+/**
+	Sample spec.tokens words with Zipf frequencies, one space apart, with
+	some capitalized or wrapped in punctuation for the tokenizer to strip.
+ */
+string makeCorpus(const CorpusSpec& spec) {
+   vector<string> words = makeVocabulary(spec);
+   mt19937 random(spec.seed + 1);
+   uniform_real_distribution<double> unit(0.0, 1.0);
+
+   vector<double> cumulative(words.size());
+   double total = 0;
+   for (size_t r = 0; r < words.size(); r++) {
+      total += 1.0 / pow(r + 1.0, spec.zipf);
+      cumulative[r] = total;
+   }
+
+   string text;
+   for (size_t t = 0; t < spec.tokens && !words.empty(); t++) {
+      size_t r = lower_bound(cumulative.begin(), cumulative.end(), unit(random) * total) - cumulative.begin();
+      string word = words[min(r, words.size() - 1)];
+      if (unit(random) < spec.noise) {
+         switch (random() % 3) {
+            case 0: word[0] = word[0] - 'a' + 'A'; break;
+            case 1: word += ","; break;
+            case 2: word = "\"" + word + "."; break;
+         }
+      }
+      text += word;
+      text += (t % 16 == 15) ? '\n' : ' ';
+   }
+   return text;
+}
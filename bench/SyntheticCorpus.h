@@ -0,0 +1,41 @@
+/** 	
+	@name SyntheticCorpus.h
+	@author Robert Shannon
+	@email rshannon@buffalo.edu
+	
+	Reproducible synthetic text for benchmarks. A vocabulary is grown
+	word by word, each new word either random or one edit away from an
+	earlier word, and then sampled with Zipf frequencies like natural
+	text. The same spec and seed always give the same corpus.
+ */
+
+#ifndef SYNTHETICCORPUS_H_
+#define SYNTHETICCORPUS_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+struct CorpusSpec {
+   size_t vocabulary;       // distinct words
+   size_t tokens;           // words in the corpus
+   double meanLength;       // mean word length (lengths are 1 + Poisson)
+   int maxLength;
+   double neighborDensity;  // chance a new word is an edit of an earlier one
+   double zipf;             // exponent of the word frequency distribution
+   double noise;            // chance a token is capitalized or punctuated
+   unsigned seed;
+
+   CorpusSpec();
+};
+
+bool parseCorpusOption(int argc, char* argv[], int& i, CorpusSpec& spec);
+void printCorpusOptions(ostream& out);
+void writeCorpusSpec(ostream& out, const CorpusSpec& spec);
+
+vector<string> makeVocabulary(const CorpusSpec& spec);
+string makeCorpus(const CorpusSpec& spec);
+
+#endif